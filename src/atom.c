@@ -0,0 +1,134 @@
+// NOTE: An `Atom` names an interned string. Identifiers are interned by the tokenizer so that every
+// occurrence of a name shares one canonical copy of its text and a precomputed hash. Two interned
+// strings are equal if and only if their text pointers are equal.
+//
+// The table is split into shards, each with its own lock, so that files parsed on different
+// threads rarely contend. Atom data is stored in fixed size chunks that never move, so reading it
+// needs no lock.
+
+typedef u32 Atom; // NOTE: 0 is the null atom
+
+typedef struct AtomData {
+	String string;
+	u64    hash;
+} AtomData;
+
+#define ATOM_SHARD_BITS   4
+#define ATOM_SHARD_COUNT  (1<<ATOM_SHARD_BITS)
+#define ATOM_CHUNK_BITS   10
+#define ATOM_CHUNK_SIZE   (1<<ATOM_CHUNK_BITS)
+#define ATOM_CHUNK_MAX    4096
+#define ATOM_STRING_BLOCK gb_kilobytes(64)
+
+typedef struct AtomShard {
+	gbMutex    mutex;
+	AtomData * chunks[ATOM_CHUNK_MAX];
+	isize      count;      // NOTE: Index 0 of shard 0 is the null atom
+	Atom *     slots;      // NOTE: Open addressing, 0 if empty
+	isize      slot_count; // NOTE: Power of two
+	u8 *       string_block;
+	isize      string_block_remaining;
+} AtomShard;
+
+gb_global AtomShard atom_shards[ATOM_SHARD_COUNT] = {0};
+
+void init_atoms(void) {
+	for (isize i = 0; i < ATOM_SHARD_COUNT; i++) {
+		AtomShard *s = &atom_shards[i];
+		gb_mutex_init(&s->mutex);
+		s->slot_count = 1024;
+		s->slots = gb_alloc_array(heap_allocator(), Atom, s->slot_count);
+		gb_zero_size(s->slots, gb_size_of(Atom)*s->slot_count);
+		s->count = (i == 0) ? 1 : 0;
+	}
+	atom_shards[0].chunks[0] = gb_alloc_array(heap_allocator(), AtomData, ATOM_CHUNK_SIZE);
+	gb_zero_item(&atom_shards[0].chunks[0][0]);
+}
+
+gb_inline AtomData *atom_data(Atom atom) {
+	AtomShard *s = &atom_shards[atom & (ATOM_SHARD_COUNT-1)];
+	u32 index = atom >> ATOM_SHARD_BITS;
+	return &s->chunks[index >> ATOM_CHUNK_BITS][index & (ATOM_CHUNK_SIZE-1)];
+}
+
+gb_inline String atom_string(Atom atom) { return atom_data(atom)->string; }
+gb_inline u64    atom_hash  (Atom atom) { return atom_data(atom)->hash;   }
+
+// NOTE: Must match `hash_string` so interned and plain strings can key the same map
+gb_inline HashKey hash_atom(Atom atom) {
+	AtomData *d = atom_data(atom);
+	HashKey h = {HashKey_String};
+	h.key    = d->hash;
+	h.string = d->string;
+	return h;
+}
+
+void atom__grow_slots(AtomShard *s) {
+	isize new_count = s->slot_count*2;
+	Atom *new_slots = gb_alloc_array(heap_allocator(), Atom, new_count);
+	gb_zero_size(new_slots, gb_size_of(Atom)*new_count);
+	for (isize i = 0; i < s->slot_count; i++) {
+		Atom atom = s->slots[i];
+		if (atom != 0) {
+			isize j = cast(isize)(atom_hash(atom) >> ATOM_SHARD_BITS) & (new_count-1);
+			while (new_slots[j] != 0) {
+				j = (j+1) & (new_count-1);
+			}
+			new_slots[j] = atom;
+		}
+	}
+	gb_free(heap_allocator(), s->slots);
+	s->slots = new_slots;
+	s->slot_count = new_count;
+}
+
+Atom intern_string(String str) {
+	u64 hash = gb_fnv64a(str.text, str.len);
+	u32 shard_index = cast(u32)(hash & (ATOM_SHARD_COUNT-1));
+	AtomShard *s = &atom_shards[shard_index];
+
+	gb_mutex_lock(&s->mutex);
+	isize mask = s->slot_count-1;
+	isize i = cast(isize)(hash >> ATOM_SHARD_BITS) & mask;
+	for (;;) {
+		Atom atom = s->slots[i];
+		if (atom == 0) {
+			break;
+		}
+		AtomData *d = atom_data(atom);
+		if (d->hash == hash && str_eq(d->string, str)) {
+			gb_mutex_unlock(&s->mutex);
+			return atom;
+		}
+		i = (i+1) & mask;
+	}
+
+	isize index = s->count++;
+	GB_ASSERT_MSG((index >> ATOM_CHUNK_BITS) < ATOM_CHUNK_MAX, "Too many interned strings");
+	AtomData **chunk = &s->chunks[index >> ATOM_CHUNK_BITS];
+	if (*chunk == NULL) {
+		*chunk = gb_alloc_array(heap_allocator(), AtomData, ATOM_CHUNK_SIZE);
+	}
+
+	if (s->string_block_remaining < str.len) {
+		isize size = gb_max(str.len, ATOM_STRING_BLOCK);
+		s->string_block = cast(u8 *)gb_alloc(heap_allocator(), size);
+		s->string_block_remaining = size;
+	}
+	u8 *text = s->string_block;
+	gb_memmove(text, str.text, str.len);
+	s->string_block += str.len;
+	s->string_block_remaining -= str.len;
+
+	Atom atom = (cast(u32)index << ATOM_SHARD_BITS) | shard_index;
+	AtomData *d = &(*chunk)[index & (ATOM_CHUNK_SIZE-1)];
+	d->string = make_string(text, str.len);
+	d->hash   = hash;
+	s->slots[i] = atom;
+
+	if (s->count*2 > s->slot_count) {
+		atom__grow_slots(s);
+	}
+	gb_mutex_unlock(&s->mutex);
+	return atom;
+}
@@ -0,0 +1,450 @@
+// NOTE: A benchmark of the compiler's throughput on synthetic projects.
+//
+// `odin bench_generate <dir> [params]` writes a project made of `files` files plus main.odin. Each
+// file has `procs` procedures that call each other and into the files it imports (up to `fanout` of
+// the files before it). It also has a struct nested `depth` times, an overload set of `overloads`
+// procedures and a chain of `usings` structs embedded with `using`.
+//
+// `odin bench` generates each project of `bench_suite` and builds it `runs` times with
+// `-timings-json`. It keeps the best time of each phase, along with the peak memory and the size
+// of the executable. The results are compared with a baseline file, or written to it with
+// `-save-baseline`. Flags it does not know are passed on to `odin build`, e.g. `-profile=release`.
+
+#if defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+typedef struct BenchParams {
+	isize files;
+	isize procs;     // NOTE: Per file
+	isize depth;     // NOTE: Of the nested struct of each file
+	isize overloads; // NOTE: Per file, at most `gb_count_of(bench_overload_types)`
+	isize usings;    // NOTE: Length of the `using` chain of each file
+	isize fanout;    // NOTE: Files imported by each file
+} BenchParams;
+
+typedef struct BenchConfig {
+	char *      name;
+	BenchParams params;
+} BenchConfig;
+
+// NOTE: Each one stresses a different part of the front end. Changing these invalidates baselines.
+gb_global BenchConfig const bench_suite[] = {
+	{"procs",     {  8, 200,  2,  2,  1,  1}},
+	{"files",     { 64,  20,  2,  2,  1,  2}},
+	{"structs",   {  8,  20, 32,  2,  1,  1}},
+	{"overloads", {  8,  20,  2, 12,  1,  1}},
+	{"usings",    {  8,  20,  2,  2, 32,  1}},
+	{"imports",   { 32,  10,  2,  2,  1, 16}},
+};
+
+gb_global char *const bench_overload_types[] = {
+	"int", "i8", "i16", "i32", "i64", "u8", "u16", "u32", "u64", "uint", "f32", "f64",
+};
+
+BenchParams bench_default_params(void) {
+	BenchParams p = {16, 50, 4, 4, 4, 2};
+	return p;
+}
+
+// NOTE: `value` must be a positive integer and nothing else
+bool bench__parse_count(String name, String value, isize *count) {
+	char *end = NULL;
+	i64 n = 0;
+	if (value.len > 0) {
+		n = gb_str_to_i64(cast(char *)value.text, &end, 10);
+	}
+	if (value.len == 0 || end != cast(char *)value.text+value.len || n < 1) {
+		gb_printf_err("`%.*s` expects a positive integer, got `%.*s`\n", LIT(name), LIT(value));
+		return false;
+	}
+	*count = cast(isize)n;
+	return true;
+}
+
+// NOTE: Returns false if `name` is not one of the parameters or `value` is invalid
+bool bench_parse_param(BenchParams *p, String name, String value) {
+	isize *dst = NULL;
+	if      (str_eq(name, str_lit("-files")))     dst = &p->files;
+	else if (str_eq(name, str_lit("-procs")))     dst = &p->procs;
+	else if (str_eq(name, str_lit("-depth")))     dst = &p->depth;
+	else if (str_eq(name, str_lit("-overloads"))) dst = &p->overloads;
+	else if (str_eq(name, str_lit("-usings")))    dst = &p->usings;
+	else if (str_eq(name, str_lit("-fanout")))    dst = &p->fanout;
+	if (dst == NULL) {
+		gb_printf_err("Unknown flag: `%.*s`\n", LIT(name));
+		return false;
+	}
+	return bench__parse_count(name, value, dst);
+}
+
+void bench__split_flag(String flag, String *name, String *value) {
+	*name = flag;
+	*value = make_string(NULL, 0);
+	for (isize j = 0; j < flag.len; j++) {
+		if (flag.text[j] == '=') {
+			*name  = make_string(flag.text, j);
+			*value = make_string(flag.text+j+1, flag.len-j-1);
+			break;
+		}
+	}
+}
+
+// NOTE: `path` may come from gb_bprintf
+bool bench__create_file(gbFile *f, char *path) {
+	if (gb_file_create(f, path) != gbFileError_None) {
+		gb_printf_err("Unable to create %s\n", path);
+		return false;
+	}
+	return true;
+}
+
+void bench__write_file(gbFile *f, BenchParams p, isize index) {
+	isize i = index;
+	for (isize k = 1; k <= p.fanout && i-k >= 0; k++) {
+		gb_fprintf(f, "#import \"file_%td.odin\";\n", i-k);
+	}
+	gb_fprintf(f, "\n");
+
+	gb_fprintf(f, "S%td_0 :: struct {\n\ta: int,\n\tb: f64,\n}\n", i);
+	for (isize d = 1; d < p.depth; d++) {
+		gb_fprintf(f, "S%td_%td :: struct {\n\tinner: S%td_%td,\n\tv:     int,\n}\n", i, d, i, d-1);
+	}
+	gb_fprintf(f, "U%td_0 :: struct {\n\tx0: int,\n}\n", i);
+	for (isize u = 1; u < p.usings; u++) {
+		gb_fprintf(f, "U%td_%td :: struct {\n\tusing b%td: U%td_%td,\n\tx%td: int,\n}\n", i, u, u, i, u-1, u);
+	}
+	for (isize o = 0; o < p.overloads; o++) {
+		gb_fprintf(f, "ov%td :: proc(x: %s) -> int { return int(x) + %td; }\n", i, bench_overload_types[o], o);
+	}
+	gb_fprintf(f, "\n");
+
+	for (isize j = 0; j < p.procs; j++) {
+		gb_fprintf(f, "f%td_p%td :: proc(x: int) -> int {\n", i, j);
+		gb_fprintf(f, "\ty := x*3 + %td;\n", j);
+		gb_fprintf(f, "\tfor k := 0; k < 4; k += 1 {\n\t\ty += k;\n\t}\n");
+		gb_fprintf(f, "\tif y > 1000 {\n\t\ty = y %% 997;\n\t}\n");
+		if (j > 0) {
+			gb_fprintf(f, "\ty += f%td_p%td(y/2);\n", i, j-1);
+		}
+		if (i > 0 && p.fanout > 0) {
+			isize imported = i - 1 - (j % gb_min(p.fanout, i));
+			gb_fprintf(f, "\ty += file_%td.f%td_p%td(y/3);\n", imported, imported, j % p.procs);
+		}
+		gb_fprintf(f, "\treturn y;\n}\n\n");
+	}
+
+	gb_fprintf(f, "run%td :: proc(x: int) -> int {\n", i);
+	gb_fprintf(f, "\ts: S%td_%td;\n\ts", i, p.depth-1);
+	for (isize d = 1; d < p.depth; d++) {
+		gb_fprintf(f, ".inner");
+	}
+	gb_fprintf(f, ".a = x;\n");
+	gb_fprintf(f, "\tu: U%td_%td;\n\tu.x0 = x;\n", i, p.usings-1);
+	gb_fprintf(f, "\ty := f%td_p%td(x) + u.x0 + s", i, p.procs-1);
+	for (isize d = 1; d < p.depth; d++) {
+		gb_fprintf(f, ".inner");
+	}
+	gb_fprintf(f, ".a;\n");
+	for (isize o = 0; o < p.overloads; o++) {
+		gb_fprintf(f, "\ty += ov%td(%s(x));\n", i, bench_overload_types[o]);
+	}
+	gb_fprintf(f, "\treturn y;\n}\n");
+}
+
+bool bench_generate(String dir, BenchParams p) {
+	p.overloads = gb_min(p.overloads, gb_count_of(bench_overload_types));
+	if (!cache_make_dir(dir)) {
+		gb_printf_err("Unable to create the directory %.*s\n", LIT(dir));
+		return false;
+	}
+
+	for (isize i = 0; i < p.files; i++) {
+		gbFile f = {0};
+		if (!bench__create_file(&f, gb_bprintf("%.*s/file_%td.odin", LIT(dir), i))) {
+			return false;
+		}
+		bench__write_file(&f, p, i);
+		gb_file_close(&f);
+	}
+
+	gbFile f = {0};
+	if (!bench__create_file(&f, gb_bprintf("%.*s/main.odin", LIT(dir)))) {
+		return false;
+	}
+	gb_fprintf(&f, "#import \"fmt.odin\";\n");
+	for (isize i = 0; i < p.files; i++) {
+		gb_fprintf(&f, "#import \"file_%td.odin\";\n", i);
+	}
+	gb_fprintf(&f, "\nmain :: proc() {\n\ttotal := 0;\n");
+	for (isize i = 0; i < p.files; i++) {
+		gb_fprintf(&f, "\ttotal += file_%td.run%td(total %% 100);\n", i, i);
+	}
+	gb_fprintf(&f, "\tfmt.println(total);\n}\n");
+	gb_file_close(&f);
+	return true;
+}
+
+
+// NOTE: All metrics are better when lower
+typedef struct BenchMetric {
+	String name; // NOTE: e.g. "procs/type check/wall_ms"
+	f64    value;
+} BenchMetric;
+
+typedef Array(BenchMetric) BenchMetrics;
+
+// NOTE: Keeps the lowest value seen for each metric
+void bench__record(BenchMetrics *metrics, String name, f64 value) {
+	for_array(i, *metrics) {
+		BenchMetric *m = &metrics->e[i];
+		if (str_eq(m->name, name)) {
+			m->value = gb_min(m->value, value);
+			return;
+		}
+	}
+	gbString copy = gb_string_make_length(heap_allocator(), name.text, name.len);
+	BenchMetric m = {make_string(cast(u8 *)copy, name.len), value};
+	array_add(metrics, m);
+}
+
+// NOTE: Finds `"key": ` at or after `*offset` and returns the text of the value that follows
+bool bench__json_find(String json, char *key, isize *offset, String *value) {
+	String pattern = make_string_c(gb_bprintf("\"%s\": ", key));
+	for (isize i = *offset; i+pattern.len <= json.len; i++) {
+		if (gb_memcompare(json.text+i, pattern.text, pattern.len) != 0) {
+			continue;
+		}
+		isize start = i+pattern.len;
+		isize end = start;
+		if (start < json.len && json.text[start] == '"') {
+			start++;
+			end = start;
+			while (end < json.len && json.text[end] != '"') {
+				end++;
+			}
+		} else {
+			while (end < json.len && json.text[end] != ',' && json.text[end] != '}') {
+				end++;
+			}
+		}
+		*value = make_string(json.text+start, end-start);
+		*offset = end;
+		return true;
+	}
+	return false;
+}
+
+f64 bench__to_f64(String s) {
+	char *text = gb_bprintf("%.*s", LIT(s));
+	return gb_str_to_f64(text, NULL);
+}
+
+// NOTE: Reads what `timings_write_json` wrote
+bool bench__read_timings(BenchMetrics *metrics, char *bench_name, String path) {
+	gbFileContents fc = gb_file_read_contents(heap_allocator(), true, gb_bprintf("%.*s", LIT(path)));
+	if (fc.data == NULL) {
+		return false;
+	}
+	String json = make_string(cast(u8 *)fc.data, fc.size);
+
+	isize offset = 0;
+	String value = {0};
+	// NOTE: The values are converted before the names are formatted as both use gb_bprintf
+	if (bench__json_find(json, "total", &offset, &value) && bench__json_find(json, "wall_ms", &offset, &value)) {
+		f64 ms = bench__to_f64(value);
+		bench__record(metrics, make_string_c(gb_bprintf("%s/total/wall_ms", bench_name)), ms);
+	}
+	if (bench__json_find(json, "peak_rss_bytes", &offset, &value)) {
+		f64 bytes = bench__to_f64(value);
+		bench__record(metrics, make_string_c(gb_bprintf("%s/peak_rss_bytes", bench_name)), bytes);
+	}
+	String section = {0};
+	while (bench__json_find(json, "name", &offset, &section) && bench__json_find(json, "wall_ms", &offset, &value)) {
+		f64 ms = bench__to_f64(value);
+		bench__record(metrics, make_string_c(gb_bprintf("%s/%.*s/wall_ms", bench_name, LIT(section))), ms);
+	}
+
+	gb_file_free_contents(&fc);
+	return true;
+}
+
+// NOTE: One metric per line, the value then a tab then the name
+bool bench__read_baseline(BenchMetrics *metrics, String path) {
+	gbFileContents fc = gb_file_read_contents(heap_allocator(), true, gb_bprintf("%.*s", LIT(path)));
+	if (fc.data == NULL) {
+		return false;
+	}
+	String text = make_string(cast(u8 *)fc.data, fc.size);
+	isize line_start = 0;
+	for (isize i = 0; i <= text.len; i++) {
+		if (i < text.len && text.text[i] != '\n') {
+			continue;
+		}
+		String line = make_string(text.text+line_start, i-line_start);
+		line_start = i+1;
+		for (isize j = 0; j < line.len; j++) {
+			if (line.text[j] == '\t') {
+				String name = make_string(line.text+j+1, line.len-j-1);
+				if (name.len > 0 && name.text[name.len-1] == '\r') {
+					name.len--;
+				}
+				bench__record(metrics, name, bench__to_f64(make_string(line.text, j)));
+				break;
+			}
+		}
+	}
+	gb_file_free_contents(&fc);
+	return true;
+}
+
+bool bench__write_baseline(BenchMetrics metrics, String path) {
+	gbFile f = {0};
+	if (gb_file_create(&f, gb_bprintf("%.*s", LIT(path))) != gbFileError_None) {
+		gb_printf_err("Unable to create %.*s\n", LIT(path));
+		return false;
+	}
+	for_array(i, metrics) {
+		gb_fprintf(&f, "%.3f\t%.*s\n", metrics.e[i].value, LIT(metrics.e[i].name));
+	}
+	gb_file_close(&f);
+	return true;
+}
+
+// NOTE: Times below the floor are too short to compare
+#define BENCH_TIME_FLOOR_MS 5.0
+
+// NOTE: Returns the number of metrics that got worse by more than `threshold` percent
+isize bench__compare(BenchMetrics current, BenchMetrics baseline, f64 threshold) {
+	isize regressions = 0;
+	gb_printf("baseline\tcurrent\tchange\tmetric\n");
+	for_array(i, current) {
+		BenchMetric m = current.e[i];
+		BenchMetric *base = NULL;
+		for_array(j, baseline) {
+			if (str_eq(baseline.e[j].name, m.name)) {
+				base = &baseline.e[j];
+				break;
+			}
+		}
+		if (base == NULL) {
+			gb_printf("-\t%.3f\tnew\t%.*s\n", m.value, LIT(m.name));
+			continue;
+		}
+		f64 change = base->value > 0 ? 100.0*(m.value - base->value)/base->value : 0;
+		String time_suffix = str_lit("/wall_ms");
+		bool is_time = m.name.len >= time_suffix.len &&
+		               str_eq(make_string(m.name.text+m.name.len-time_suffix.len, time_suffix.len), time_suffix);
+		bool is_noise = is_time && gb_max(m.value, base->value) < BENCH_TIME_FLOOR_MS;
+		bool is_regression = !is_noise && change > threshold;
+		if (is_regression) {
+			regressions++;
+		}
+		gb_printf("%.3f\t%.3f\t%s%.1f%%\t%.*s%s\n", base->value, m.value, change >= 0 ? "+" : "", change,
+		          LIT(m.name), is_regression ? "\t<-- regression" : "");
+	}
+	return regressions;
+}
+
+int bench_generate_command(int argc, char **argv) {
+	if (argc < 3) {
+		gb_printf_err("Usage: %s bench_generate <dir> [-files=n] [-procs=n] [-depth=n] [-overloads=n] [-usings=n] [-fanout=n]\n", argv[0]);
+		return 1;
+	}
+	BenchParams params = bench_default_params();
+	for (int i = 3; i < argc; i++) {
+		String name, value;
+		bench__split_flag(make_string_c(argv[i]), &name, &value);
+		if (!bench_parse_param(&params, name, value)) {
+			return 1;
+		}
+	}
+	return bench_generate(make_string_c(argv[2]), params) ? 0 : 1;
+}
+
+int bench_command(int argc, char **argv) {
+	String baseline_path = str_lit("bench_baseline.txt");
+	String work_dir      = str_lit("bench_out");
+	bool   save_baseline = false;
+	isize  runs          = 3;
+	f64    threshold     = 10.0;
+	Array(char *) build_flags = {0};
+	array_init(&build_flags, heap_allocator());
+
+	for (int i = 2; i < argc; i++) {
+		String name, value;
+		bench__split_flag(make_string_c(argv[i]), &name, &value);
+		if (str_eq(name, str_lit("-baseline"))) {
+			baseline_path = value;
+		} else if (str_eq(name, str_lit("-save-baseline"))) {
+			save_baseline = true;
+		} else if (str_eq(name, str_lit("-dir"))) {
+			work_dir = value;
+		} else if (str_eq(name, str_lit("-runs"))) {
+			if (!bench__parse_count(name, value, &runs)) {
+				return 1;
+			}
+		} else if (str_eq(name, str_lit("-threshold"))) {
+			threshold = bench__to_f64(value);
+		} else {
+			array_add(&build_flags, argv[i]);
+		}
+	}
+
+	BenchMetrics current = {0};
+	array_init(&current, heap_allocator());
+	for (isize b = 0; b < gb_count_of(bench_suite); b++) {
+		BenchConfig config = bench_suite[b];
+		String dir = make_string_c(gb_bprintf("%.*s/%s", LIT(work_dir), config.name));
+		dir = make_string_c(cast(char *)gb_alloc_copy(heap_allocator(), dir.text, dir.len+1));
+		if (!bench_generate(dir, config.params)) {
+			return 1;
+		}
+		String json_path = make_string_c(gb_bprintf("%.*s/timings.json", LIT(dir)));
+		json_path = make_string_c(cast(char *)gb_alloc_copy(heap_allocator(), json_path.text, json_path.len+1));
+
+		for (isize r = 0; r < runs; r++) {
+			gb_printf_err("%s: run %td of %td\n", config.name, r+1, runs);
+			ExecArgs args = {0};
+			exec_args_init(&args);
+			exec_arg(&args, "%s", argv[0]);
+			exec_arg(&args, "build");
+			exec_arg(&args, "%.*s/main.odin", LIT(dir));
+			exec_arg(&args, "-timings-json=%.*s", LIT(json_path));
+			for_array(i, build_flags) {
+				exec_arg(&args, "%s", build_flags.e[i]);
+			}
+			i32 exit_code = exec_process("odin build", false, args);
+			exec_args_destroy(&args);
+			if (exit_code != 0 || !bench__read_timings(&current, config.name, json_path)) {
+				gb_printf_err("Failed to build the benchmark `%s`\n", config.name);
+				return 1;
+			}
+		}
+
+		struct stat st = {0};
+		if (stat(gb_bprintf("%.*s/main", LIT(dir)), &st) == 0) {
+			bench__record(&current, make_string_c(gb_bprintf("%s/output_bytes", config.name)), cast(f64)st.st_size);
+		}
+	}
+
+	if (save_baseline) {
+		if (!bench__write_baseline(current, baseline_path)) {
+			return 1;
+		}
+		gb_printf("Wrote the baseline to %.*s\n", LIT(baseline_path));
+		return 0;
+	}
+
+	BenchMetrics baseline = {0};
+	array_init(&baseline, heap_allocator());
+	if (!bench__read_baseline(&baseline, baseline_path)) {
+		gb_printf_err("No baseline at %.*s, run with -save-baseline to create one\n", LIT(baseline_path));
+		bench__compare(current, baseline, threshold);
+		return 1;
+	}
+	isize regressions = bench__compare(current, baseline, threshold);
+	if (regressions > 0) {
+		gb_printf("%td metrics are more than %.1f%% worse than the baseline\n", regressions, threshold);
+		return 1;
+	}
+	return 0;
+}
+#endif
@@ -1,3 +1,18 @@
+// NOTE: A build profile selects the optimization pipeline and the matching llc and link flags
+typedef enum BuildProfileKind {
+	BuildProfile_Debug,
+	BuildProfile_Release,
+	BuildProfile_ReleaseNative, // NOTE: Release, also using every instruction set extension of this machine
+
+	BuildProfile_Count,
+} BuildProfileKind;
+
+String const build_profile_names[BuildProfile_Count] = {
+	{cast(u8 *)"debug",          5},
+	{cast(u8 *)"release",        7},
+	{cast(u8 *)"release-native", 14},
+};
+
 // This stores the information for the specify architecture of this build
 typedef struct BuildContext {
 	// Constants
@@ -15,6 +30,24 @@ typedef struct BuildContext {
 	String llc_flags;
 	String link_flags;
 	bool   is_dll;
+
+	// Set by the build profile
+	BuildProfileKind profile;
+	String opt_flags;          // Passes run by opt
+	i32    optimization_level; // -O level of llc
+	String cpu_flags;          // Target features given to both opt and llc
+	String profile_llc_flags;
+	String profile_link_flags;
+
+	isize  thread_count;  // Worker threads used by the front end, 1 means single threaded
+	bool   stream_tokens; // Parser pulls tokens as it goes rather than tokenizing whole files first
+	isize  job_count;     // Child processes (e.g. llc) the backend may run at once
+	isize  backend_jobs;  // Modules the program is split into for opt and llc, 1 means a single module
+	bool   keep_temps;    // Write the .ll and .bc files rather than piping them through opt and llc
+	String cache_dir;     // Where the object of core/ is cached, empty to always compile it (see cache.c)
+	bool   show_timings;
+	bool   show_memory;   // Report the memory of each subsystem, see `tagged_allocator`
+	String timings_json_path; // Empty if the timings are not written out
 } BuildContext;
 
 
@@ -195,19 +228,20 @@ String odin_root_dir(void) {
 
 
 #if defined(GB_SYSTEM_WINDOWS)
+// NOTE: This is called from the parse workers so it cannot use the shared `string_buffer_arena`
 String path_to_fullpath(gbAllocator a, String s) {
-	gbTempArenaMemory tmp = gb_temp_arena_memory_begin(&string_buffer_arena);
-	String16 string16 = string_to_string16(string_buffer_allocator, s);
+	String16 string16 = string_to_string16(heap_allocator(), s);
 	String result = {0};
 
 	DWORD len = GetFullPathNameW(string16.text, 0, NULL, NULL);
 	if (len != 0) {
-		wchar_t *text = gb_alloc_array(string_buffer_allocator, wchar_t, len+1);
+		wchar_t *text = gb_alloc_array(heap_allocator(), wchar_t, len+1);
 		GetFullPathNameW(string16.text, len, text, NULL);
 		text[len] = 0;
 		result = string16_to_string(a, make_string16(text, len));
+		gb_free(heap_allocator(), text);
 	}
-	gb_temp_arena_memory_end(tmp);
+	gb_free(heap_allocator(), string16.text);
 	return result;
 }
 #elif defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
@@ -215,7 +249,12 @@ String path_to_fullpath(gbAllocator a, String s) {
 	char *p = realpath(cast(char *)s.text, 0);
 	if(p == NULL) return make_string_c("");
 
-	return make_string_c(p);
+	// NOTE: Copied so that it can be freed with `a` like on Windows, and stays null terminated
+	isize len = gb_strlen(p);
+	u8 *text = gb_alloc_array(a, u8, len+1);
+	gb_memmove(text, p, len+1);
+	free(p);
+	return make_string(text, len);
 }
 #else
 #error Implement system
@@ -260,12 +299,185 @@ String get_fullpath_core(gbAllocator a, String path) {
 
 
 
+#if defined(GB_CPU_X86)
+#if defined(GB_COMPILER_MSVC)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+void cpu__cpuid(u32 leaf, u32 subleaf, u32 regs[4]) {
+#if defined(GB_COMPILER_MSVC)
+	__cpuidex(cast(int *)regs, leaf, subleaf);
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+u64 cpu__xgetbv(u32 index) {
+#if defined(GB_COMPILER_MSVC)
+	return _xgetbv(index);
+#else
+	u32 eax, edx;
+	__asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+	return (cast(u64)edx << 32) | eax;
+#endif
+}
+
+// NOTE: The `-mattr` for opt and llc enabling the instruction set extensions of this machine that
+// the operating system also supports (AVX needs the OS to save the YMM registers)
+String cpu_native_feature_flags(void) {
+	u32 regs[4] = {0};
+	cpu__cpuid(0, 0, regs);
+	u32 max_leaf = regs[0];
+	if (max_leaf < 1) {
+		return str_lit("");
+	}
+
+	u32 leaf1[4] = {0};
+	u32 leaf7[4] = {0};
+	u32 ext1[4]  = {0};
+	cpu__cpuid(1, 0, leaf1);
+	if (max_leaf >= 7) {
+		cpu__cpuid(7, 0, leaf7);
+	}
+	cpu__cpuid(0x80000000, 0, regs);
+	if (regs[0] >= 0x80000001) {
+		cpu__cpuid(0x80000001, 0, ext1);
+	}
+
+	u32 ebx7 = leaf7[1], ecx1 = leaf1[2], ecx_ext = ext1[2];
+	bool os_avx = false;
+	if ((ecx1 & (1<<27)) != 0) { // OSXSAVE
+		os_avx = (cpu__xgetbv(0) & 6) == 6;
+	}
+	bool avx = os_avx && (ecx1 & (1<<28)) != 0;
+
+	struct {char *name; bool enabled;} features[] = {
+		{"sse3",   (ecx1 & (1<<0))  != 0},
+		{"pclmul", (ecx1 & (1<<1))  != 0},
+		{"ssse3",  (ecx1 & (1<<9))  != 0},
+		{"sse4.1", (ecx1 & (1<<19)) != 0},
+		{"sse4.2", (ecx1 & (1<<20)) != 0},
+		{"popcnt", (ecx1 & (1<<23)) != 0},
+		{"aes",    (ecx1 & (1<<25)) != 0},
+		{"avx",    avx},
+		{"f16c",   avx && (ecx1 & (1<<29)) != 0},
+		{"fma",    avx && (ecx1 & (1<<12)) != 0},
+		{"avx2",   avx && (ebx7 & (1<<5))  != 0},
+		{"bmi",    (ebx7 & (1<<3))    != 0},
+		{"bmi2",   (ebx7 & (1<<8))    != 0},
+		{"lzcnt",  (ecx_ext & (1<<5)) != 0},
+	};
+
+	gbString str = gb_string_make(heap_allocator(), "-mattr=");
+	bool first = true;
+	for (isize i = 0; i < gb_count_of(features); i++) {
+		if (features[i].enabled) {
+			str = gb_string_appendc(str, first ? "+" : ",+");
+			str = gb_string_appendc(str, features[i].name);
+			first = false;
+		}
+	}
+	if (first) {
+		gb_string_free(str);
+		return str_lit("");
+	}
+	return make_string(cast(u8 *)str, gb_string_length(str));
+}
+#else
+String cpu_native_feature_flags(void) {
+	return str_lit("");
+}
+#endif
+
+bool set_build_profile(BuildContext *bc, String name) {
+	BuildProfileKind kind = BuildProfile_Count;
+	for (isize i = 0; i < BuildProfile_Count; i++) {
+		if (str_eq(name, build_profile_names[i])) {
+			kind = cast(BuildProfileKind)i;
+		}
+	}
+	if (kind == BuildProfile_Count) {
+		return false;
+	}
+
+	bc->profile            = kind;
+	bc->cpu_flags          = str_lit("");
+	bc->profile_llc_flags  = str_lit("");
+	bc->profile_link_flags = str_lit("");
+
+	switch (kind) {
+	case BuildProfile_Debug:
+		bc->opt_flags          = str_lit("-mem2reg -memcpyopt -die");
+		bc->optimization_level = 0;
+		break;
+
+	case BuildProfile_Release:
+	case BuildProfile_ReleaseNative:
+		bc->opt_flags          = str_lit("-O2");
+		bc->optimization_level = 2;
+		if (kind == BuildProfile_ReleaseNative) {
+			bc->opt_flags          = str_lit("-O3");
+			bc->optimization_level = 3;
+			bc->cpu_flags          = cpu_native_feature_flags();
+		}
+
+		// NOTE: Let the linker drop unused procedures and data
+	#if defined(GB_SYSTEM_WINDOWS)
+		bc->profile_link_flags = str_lit("/opt:icf");
+	#elif defined(GB_SYSTEM_OSX)
+		bc->profile_link_flags = str_lit("-dead_strip");
+	#else
+		bc->profile_llc_flags  = str_lit("-function-sections -data-sections");
+		bc->profile_link_flags = str_lit("-Wl,--gc-sections");
+	#endif
+		break;
+	}
+	return true;
+}
+
+
+#if !defined(GB_SYSTEM_WINDOWS)
+// NOTE: $XDG_CACHE_HOME/odin, or ~/.cache/odin
+String default_cache_dir(void) {
+	char *xdg  = getenv("XDG_CACHE_HOME");
+	char *home = getenv("HOME");
+	gbString dir = NULL;
+	if (xdg != NULL && xdg[0] != 0) {
+		dir = gb_string_make(heap_allocator(), xdg);
+	} else if (home != NULL && home[0] != 0) {
+		dir = gb_string_make(heap_allocator(), home);
+		dir = gb_string_appendc(dir, "/.cache");
+	} else {
+		return str_lit("");
+	}
+	dir = gb_string_appendc(dir, "/odin");
+	return make_string(cast(u8 *)dir, gb_string_length(dir));
+}
+#endif
+
 void init_build_context(void) {
 	BuildContext *bc = &build_context;
 	bc->ODIN_VENDOR  = str_lit("odin");
 	bc->ODIN_VERSION = str_lit("0.2.1");
 	bc->ODIN_ROOT    = odin_root_dir();
 
+	{
+		gbAffinity affinity = {0};
+		gb_affinity_init(&affinity);
+		bc->thread_count = gb_max(affinity.thread_count, 1);
+		bc->job_count    = bc->thread_count;
+		gb_affinity_destroy(&affinity);
+	}
+	bc->stream_tokens = true;
+	bc->backend_jobs  = 1;
+#if defined(GB_SYSTEM_WINDOWS)
+	bc->keep_temps    = true; // NOTE: The pipelined backend is only implemented on Unix
+#else
+	bc->cache_dir     = default_cache_dir();
+#endif
+
 #if defined(GB_SYSTEM_WINDOWS)
 	bc->ODIN_OS      = str_lit("windows");
 	bc->ODIN_ARCH    = str_lit("amd64");
@@ -325,4 +537,6 @@ void init_build_context(void) {
 
 	#undef LINK_FLAG_X64
 	#undef LINK_FLAG_X86
+
+	set_build_profile(bc, build_profile_names[BuildProfile_Debug]);
 }
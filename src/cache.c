@@ -0,0 +1,119 @@
+// NOTE: The procedures of core/ are compiled as a module of their own (see `irSplit`) and its
+// object is kept in `build_context.cache_dir`. The object is named after a hash of the module's
+// LLVM IR and of everything given to opt and llc, so a later build that generates the same IR for
+// core links the cached object rather than running opt and llc on it again.
+//
+// The front end still parses and checks core on every build, and the IR of core changes when
+// the program uses a different part of it or a different set of types.
+
+#if defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+#include <sys/stat.h>
+
+// NOTE: `fd.p` points at the gbString that is appended to
+gb_internal GB_FILE_READ_AT_PROC(cache__memory_read) {
+	return false;
+}
+
+gb_internal GB_FILE_WRITE_AT_PROC(cache__memory_write) {
+	gbString *str = cast(gbString *)fd.p;
+	*str = gb_string_append_length(*str, buffer, size);
+	if (bytes_written) *bytes_written = size;
+	return true;
+}
+
+gb_internal GB_FILE_SEEK_PROC(cache__memory_seek) {
+	return false;
+}
+
+gb_internal GB_FILE_CLOSE_PROC(cache__memory_close) {
+}
+
+gbFileOperations const cache_memory_file_operations = {
+	cache__memory_read,
+	cache__memory_write,
+	cache__memory_seek,
+	cache__memory_close,
+};
+
+// NOTE: A gbFile that appends everything written to it to `*buffer`
+void cache_memory_file(gbFile *f, gbString *buffer) {
+	gbFileDescriptor desc = {0};
+	desc.p = buffer;
+	gb_file_new(f, desc, cache_memory_file_operations, "<memory>");
+}
+
+// NOTE: Creates the directory and its parents if needed
+bool cache_make_dir(String dir) {
+	char *path = gb_alloc_array(heap_allocator(), char, dir.len+1);
+	gb_memmove(path, dir.text, dir.len);
+	path[dir.len] = 0;
+
+	bool ok = true;
+	for (isize i = 1; i <= dir.len && ok; i++) {
+		if (i < dir.len && path[i] != '/') {
+			continue;
+		}
+		char c = path[i];
+		path[i] = 0;
+		if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+			ok = false;
+		}
+		path[i] = c;
+	}
+	gb_free(heap_allocator(), path);
+	return ok;
+}
+
+void cache__append_hex(gbString *str, u64 x) {
+	char const *digits = "0123456789abcdef";
+	char buf[17] = {0};
+	for (isize i = 15; i >= 0; i--) {
+		buf[i] = digits[x & 15];
+		x >>= 4;
+	}
+	*str = gb_string_appendc(*str, buf);
+}
+
+// NOTE: `backend_flags` must hold everything besides the IR that affects the object
+String cache_core_object_path(String ir_text, String backend_flags) {
+	u64 flags_hash = gb_fnv64a(backend_flags.text, backend_flags.len);
+	u64 a = gb_fnv64a(ir_text.text, ir_text.len) ^ flags_hash;
+	u64 b = gb_murmur64_seed(ir_text.text, ir_text.len, flags_hash);
+
+	gbString path = gb_string_make_length(heap_allocator(), build_context.cache_dir.text, build_context.cache_dir.len);
+	path = gb_string_appendc(path, "/core-");
+	cache__append_hex(&path, a);
+	cache__append_hex(&path, b);
+	path = gb_string_appendc(path, ".o");
+	return make_string(cast(u8 *)path, gb_string_length(path));
+}
+
+bool cache_has_object(String path) {
+	char *c_path = gb_bprintf("%.*s", LIT(path));
+	return access(c_path, R_OK) == 0;
+}
+
+// NOTE: The object is written under a name unique to this process and renamed once complete, so
+// concurrent builds never see a partial object
+String cache_temp_path(String path) {
+	gbString tmp = gb_string_make_length(heap_allocator(), path.text, path.len);
+	tmp = gb_string_appendc(tmp, gb_bprintf(".%d.tmp", cast(int)getpid()));
+	return make_string(cast(u8 *)tmp, gb_string_length(tmp));
+}
+
+// NOTE: If the rename fails the object is left at `temp_path` so this build can still link it
+bool cache_commit_object(String temp_path, String path) {
+	char *c_temp = gb_alloc_array(heap_allocator(), char, temp_path.len+1);
+	gb_memmove(c_temp, temp_path.text, temp_path.len);
+	c_temp[temp_path.len] = 0;
+	char *c_path = gb_bprintf("%.*s", LIT(path));
+
+	bool ok = rename(c_temp, c_path) == 0;
+	gb_free(heap_allocator(), c_temp);
+	return ok;
+}
+
+void cache_discard_object(String temp_path) {
+	unlink(gb_bprintf("%.*s", LIT(temp_path)));
+}
+#endif
@@ -315,7 +315,6 @@ void check_proc_lit(Checker *c, Entity *e, DeclInfo *d) {
 	}
 
 	if (is_foreign) {
-		MapEntity *fp = &c->info.foreigns;
 		String name = e->token.string;
 		if (pd->foreign_name.len > 0) {
 			name = pd->foreign_name;
@@ -328,7 +327,7 @@ void check_proc_lit(Checker *c, Entity *e, DeclInfo *d) {
 			error_node(foreign_library, "#foreign library names must be an identifier");
 		} else {
 			String name = foreign_library->Ident.string;
-			Entity *found = scope_lookup_entity(c->context.scope, name);
+			Entity *found = scope_lookup_entity(c->context.scope, hash_token(foreign_library->Ident));
 			if (found == NULL) {
 				if (str_eq(name, str_lit("_"))) {
 					error_node(foreign_library, "`_` cannot be used as a value type");
@@ -347,6 +346,7 @@ void check_proc_lit(Checker *c, Entity *e, DeclInfo *d) {
 		e->Procedure.is_foreign = true;
 		e->Procedure.foreign_name = name;
 
+		MapEntity *fp = checker_lock_foreigns(c);
 		HashKey key = hash_string(name);
 		Entity **found = map_entity_get(fp, key);
 		if (found) {
@@ -358,11 +358,12 @@ void check_proc_lit(Checker *c, Entity *e, DeclInfo *d) {
 				error_node(d->proc_lit,
 						   "Redeclaration of #foreign procedure `%.*s` with different type signatures\n"
 						   "\tat %.*s(%td:%td)",
-						   LIT(name), LIT(pos.file), pos.line, pos.column);
+						   LIT(name), LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 			}
 		} else {
 			map_entity_set(fp, key, e);
 		}
+		checker_unlock_foreigns(c);
 	} else {
 		String name = e->token.string;
 		if (is_link_name) {
@@ -370,10 +371,9 @@ void check_proc_lit(Checker *c, Entity *e, DeclInfo *d) {
 		}
 
 		if (is_link_name || is_export) {
-			MapEntity *fp = &c->info.foreigns;
-
 			e->Procedure.link_name = name;
 
+			MapEntity *fp = checker_lock_foreigns(c);
 			HashKey key = hash_string(name);
 			Entity **found = map_entity_get(fp, key);
 			if (found) {
@@ -383,10 +383,11 @@ void check_proc_lit(Checker *c, Entity *e, DeclInfo *d) {
 				error_node(d->proc_lit,
 						   "Non unique linking name for procedure `%.*s`\n"
 						   "\tother at %.*s(%td:%td)",
-						   LIT(name), LIT(pos.file), pos.line, pos.column);
+						   LIT(name), LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 			} else {
 				map_entity_set(fp, key, e);
 			}
+			checker_unlock_foreigns(c);
 		}
 	}
 
@@ -439,7 +440,7 @@ void check_entity_decl(Checker *c, Entity *e, DeclInfo *d, Type *named_type) {
 	}
 
 	if (d == NULL) {
-		DeclInfo **found = map_decl_info_get(&c->info.entities, hash_pointer(e));
+		DeclInfo **found = checker_decl_info_of_entity(c, e);
 		if (found) {
 			d = *found;
 		} else {
@@ -507,10 +508,10 @@ void check_proc_body(Checker *c, Token token, DeclInfo *decl, Type *type, AstNod
 			String name = e->token.string;
 			Type *t = base_type(type_deref(e->type));
 			if (is_type_struct(t) || is_type_raw_union(t)) {
-				Scope **found = map_scope_get(&c->info.scopes, hash_pointer(t->Record.node));
+				Scope *found = scope_of_node(&c->info, t->Record.node);
 				GB_ASSERT(found != NULL);
-				for_array(i, (*found)->elements.entries) {
-					Entity *f = (*found)->elements.entries.e[i].value;
+				for_array(i, found->elements.entries) {
+					Entity *f = found->elements.entries.e[i].value;
 					if (f->kind == Entity_Variable) {
 						Entity *uvar = make_entity_using_variable(c->allocator, e, f->token, f->type);
 						uvar->Variable.is_immutable = is_immutable;
@@ -548,13 +549,9 @@ void check_proc_body(Checker *c, Token token, DeclInfo *decl, Type *type, AstNod
 	check_scope_usage(c, c->context.scope);
 	c->context = old_context;
 
-	if (decl->parent != NULL) {
-		// NOTE(bill): Add the dependencies from the procedure literal (lambda)
-		for_array(i, decl->deps.entries) {
-			HashKey key = decl->deps.entries.e[i].key;
-			Entity *e = cast(Entity *)key.ptr;
-			map_bool_set(&decl->parent->deps, key, true);
-		}
+	// NOTE: Workers leave this until their results are merged, as the parent is shared
+	if (c->shared_info == NULL) {
+		add_dependencies_to_parent(decl);
 	}
 }
 
@@ -62,7 +62,7 @@ void check_scope_decls(Checker *c, AstNodeArray nodes, isize reserve_size) {
 		default:
 			continue;
 		}
-		DeclInfo **found = map_decl_info_get(&c->info.entities, hash_pointer(e));
+		DeclInfo **found = checker_decl_info_of_entity(c, e);
 		if (found != NULL) {
 			DeclInfo *d = *found;
 			check_entity_decl(c, e, d, NULL);
@@ -348,7 +348,7 @@ void populate_using_entity_map(Checker *c, AstNode *node, Type *t, MapEntity *en
 			Entity *f = t->Record.fields[i];
 			GB_ASSERT(f->kind == Entity_Variable);
 			String name = f->token.string;
-			HashKey key = hash_string(name);
+			HashKey key = hash_token(f->token);
 			Entity **found = map_entity_get(entity_map, key);
 			if (found != NULL) {
 				Entity *e = *found;
@@ -420,7 +420,7 @@ isize check_fields(Checker *c, AstNode *node, AstNodeArray decls,
 			} else if (str_eq(name_token.string, str_lit("__tag"))) {
 				error_node(name, "`__tag` is a reserved identifier for fields");
 			} else {
-				HashKey key = hash_string(name_token.string);
+				HashKey key = hash_token(name_token);
 				Entity **found = map_entity_get(&entity_map, key);
 				if (found != NULL) {
 					Entity *e = *found;
@@ -482,7 +482,7 @@ isize check_fields(Checker *c, AstNode *node, AstNodeArray decls,
 
 // TODO(bill): Cleanup struct field reordering
 // TODO(bill): Inline sorting procedure?
-gb_global gbAllocator   __checker_allocator = {0};
+gb_global gb_thread_local gbAllocator __checker_allocator = {0};
 
 GB_COMPARE_PROC(cmp_reorder_struct_fields) {
 	// Rule:
@@ -651,8 +651,7 @@ void check_union_type(Checker *c, Type *union_type, AstNode *node) {
 
 	for (isize i = 0; i < field_count; i++) {
 		Entity *f = fields[i];
-		String name = f->token.string;
-		map_entity_set(&entity_map, hash_string(name), f);
+		map_entity_set(&entity_map, hash_token(f->token), f);
 	}
 
 	union_type->Record.fields              = fields;
@@ -690,20 +689,17 @@ void check_union_type(Checker *c, Type *union_type, AstNode *node) {
 			}
 
 
-			Token token = name_token;
-			token.kind = Token_struct;
-			AstNode *dummy_struct = ast_struct_type(c->curr_ast_file, token, list, list_count, false, true, NULL);
-
-			check_open_scope(c, dummy_struct);
+			// NOTE: The variant has no struct node of its own, so its scope is recorded for the field
+			check_open_scope(c, variant);
 			Entity **fields = gb_alloc_array(c->allocator, Entity *, list_count);
-			isize field_count = check_fields(c, dummy_struct, list, fields, list_count, str_lit("variant"));
+			isize field_count = check_fields(c, variant, list, fields, list_count, str_lit("variant"));
 			base_type->Record.is_packed           = false;
 			base_type->Record.is_ordered          = true;
 			base_type->Record.fields              = fields;
 			base_type->Record.fields_in_src_order = fields;
 			base_type->Record.field_count         = field_count;
 			base_type->Record.names = make_names_field_for_record(c, c->context.scope);
-			base_type->Record.node = dummy_struct;
+			base_type->Record.node = variant;
 
 			type_set_offsets(c->allocator, base_type);
 
@@ -720,7 +716,7 @@ void check_union_type(Checker *c, Type *union_type, AstNode *node) {
 			continue;
 		}
 
-		HashKey key = hash_string(name_token.string);
+		HashKey key = hash_token(name_token);
 		if (map_entity_get(&entity_map, key) != NULL) {
 			// NOTE(bill): Scope checking already checks the declaration
 			error(name_token, "`%.*s` is already declared in this union", LIT(name_token.string));
@@ -873,7 +869,7 @@ void check_enum_type(Checker *c, Type *enum_type, Type *named_type, AstNode *nod
 		e->identifier = ident;
 		e->flags |= EntityFlag_Visited;
 
-		HashKey key = hash_string(name);
+		HashKey key = hash_token(ident->Ident);
 		if (map_entity_get(&entity_map, key) != NULL) {
 			error_node(ident, "`%.*s` is already declared in this enumeration", LIT(name));
 		} else {
@@ -1014,13 +1010,13 @@ Type *check_get_results(Checker *c, Scope *scope, AstNode *_results) {
 		Type *type = check_type(c, field->type);
 		if (field->names.count == 0) {
 			Token token = ast_node_token(field->type);
-			token.string = str_lit("");
+			token_set_string(&token, str_lit(""));
 			Entity *param = make_entity_param(c->allocator, scope, token, type, false, false);
 			variables[variable_index++] = param;
 		} else {
 			for_array(j, field->names) {
 				Token token = ast_node_token(field->type);
-				token.string = str_lit("");
+				token_set_string(&token, str_lit(""));
 
 				AstNode *name = field->names.e[j];
 				if (name->kind != AstNode_Ident) {
@@ -1259,7 +1255,7 @@ Entity *check_ident(Checker *c, Operand *o, AstNode *n, Type *named_type, Type *
 	o->expr = n;
 	String name = n->Ident.string;
 
-	Entity *e = scope_lookup_entity(c->context.scope, name);
+	Entity *e = scope_lookup_entity(c->context.scope, hash_token(n->Ident));
 	if (e == NULL) {
 		if (str_eq(name, str_lit("_"))) {
 			error(n->Ident, "`_` cannot be used as a value type");
@@ -1286,7 +1282,7 @@ Entity *check_ident(Checker *c, Operand *o, AstNode *n, Type *named_type, Type *
 
 	bool is_overloaded = false;
 	isize overload_count = 0;
-	HashKey key = hash_string(name);
+	HashKey key = hash_token(n->Ident);
 
 	if (e->kind == Entity_Procedure) {
 		// NOTE(bill): Overloads are only allowed with the same scope
@@ -1344,7 +1340,7 @@ Entity *check_ident(Checker *c, Operand *o, AstNode *n, Type *named_type, Type *
 		// return NULL;
 	}
 
-	e->flags |= EntityFlag_Used;
+	set_entity_used(c, e);
 
 	Type *type = e->type;
 	switch (e->kind) {
@@ -1361,7 +1357,6 @@ Entity *check_ident(Checker *c, Operand *o, AstNode *n, Type *named_type, Type *
 		break;
 
 	case Entity_Variable:
-		e->flags |= EntityFlag_Used;
 		if (type == t_invalid) {
 			o->type = t_invalid;
 			return e;
@@ -1519,8 +1514,7 @@ void check_map_type(Checker *c, Type *type, AstNode *node) {
 			value: Value_Type,
 		}
 		*/
-		AstNode *dummy_node = gb_alloc_item(a, AstNode);
-		dummy_node->kind = AstNode_Invalid;
+		AstNode *dummy_node = alloc_ast_node(a, AstNode_Invalid);
 		check_open_scope(c, dummy_node);
 
 		isize field_count = 3;
@@ -1548,8 +1542,7 @@ void check_map_type(Checker *c, Type *type, AstNode *node) {
 			entries; [dynamic]Entry_Type,
 		}
 		*/
-		AstNode *dummy_node = gb_alloc_item(a, AstNode);
-		dummy_node->kind = AstNode_Invalid;
+		AstNode *dummy_node = alloc_ast_node(a, AstNode_Invalid);
 		check_open_scope(c, dummy_node);
 
 		Type *hashes_type  = make_type_dynamic_array(a, t_int);
@@ -1730,7 +1723,9 @@ bool check_type_extra_internal(Checker *c, AstNode *e, Type **type, Type *named_
 		*type = make_type_struct(c->allocator);
 		set_base_type(named_type, *type);
 		check_open_scope(c, e);
+		(*type)->Record.is_being_checked = true;
 		check_struct_type(c, *type, e);
+		(*type)->Record.is_being_checked = false;
 		check_close_scope(c);
 		(*type)->Record.node = e;
 		return true;
@@ -1740,7 +1735,9 @@ bool check_type_extra_internal(Checker *c, AstNode *e, Type **type, Type *named_
 		*type = make_type_union(c->allocator);
 		set_base_type(named_type, *type);
 		check_open_scope(c, e);
+		(*type)->Record.is_being_checked = true;
 		check_union_type(c, *type, e);
+		(*type)->Record.is_being_checked = false;
 		check_close_scope(c);
 		(*type)->Record.node = e;
 		return true;
@@ -1750,7 +1747,9 @@ bool check_type_extra_internal(Checker *c, AstNode *e, Type **type, Type *named_
 		*type = make_type_raw_union(c->allocator);
 		set_base_type(named_type, *type);
 		check_open_scope(c, e);
+		(*type)->Record.is_being_checked = true;
 		check_raw_union_type(c, *type, e);
+		(*type)->Record.is_being_checked = false;
 		check_close_scope(c);
 		(*type)->Record.node = e;
 		return true;
@@ -3024,14 +3023,14 @@ bool check_index_value(Checker *c, bool open_range, AstNode *index_value, i64 ma
 	return true;
 }
 
-isize entity_overload_count(Scope *s, String name) {
-	Entity *e = scope_lookup_entity(s, name);
+isize entity_overload_count(Scope *s, HashKey key) {
+	Entity *e = scope_lookup_entity(s, key);
 	if (e == NULL) {
 		return 0;
 	}
 	if (e->kind == Entity_Procedure) {
 		// NOTE(bill): Overloads are only allowed with the same scope
-		return map_entity_multi_count(&s->elements, hash_string(e->token.string));
+		return map_entity_multi_count(&s->elements, hash_token(e->token));
 	}
 	return 1;
 }
@@ -3085,7 +3084,7 @@ Entity *check_selector(Checker *c, Operand *operand, AstNode *node, Type *type_h
 
 	if (op_expr->kind == AstNode_Ident) {
 		String op_name = op_expr->Ident.string;
-		Entity *e = scope_lookup_entity(c->context.scope, op_name);
+		Entity *e = scope_lookup_entity(c->context.scope, hash_token(op_expr->Ident));
 
 		add_entity_use(c, op_expr, e);
 		expr_entity = e;
@@ -3100,7 +3099,7 @@ Entity *check_selector(Checker *c, Operand *operand, AstNode *node, Type *type_h
 			String entity_name = selector->Ident.string;
 
 			check_op_expr = false;
-			entity = scope_lookup_entity(import_scope, entity_name);
+			entity = scope_lookup_entity(import_scope, hash_token(selector->Ident));
 			bool is_declared = entity != NULL;
 			if (is_declared) {
 				if (entity->kind == Entity_Builtin) {
@@ -3120,7 +3119,7 @@ Entity *check_selector(Checker *c, Operand *operand, AstNode *node, Type *type_h
 			check_entity_decl(c, entity, NULL, NULL);
 			GB_ASSERT(entity->type != NULL);
 
-			isize overload_count = entity_overload_count(import_scope, entity_name);
+			isize overload_count = entity_overload_count(import_scope, hash_token(selector->Ident));
 			bool is_overloaded = overload_count > 1;
 
 			bool implicit_is_found = map_bool_get(&e->ImportName.scope->implicit, hash_pointer(entity)) != NULL;
@@ -3141,7 +3140,7 @@ Entity *check_selector(Checker *c, Operand *operand, AstNode *node, Type *type_h
 			}
 
 			if (is_overloaded) {
-				HashKey key = hash_string(entity_name);
+				HashKey key = hash_token(selector->Ident);
 				bool skip = false;
 
 				Entity **procs = gb_alloc_array(heap_allocator(), Entity *, overload_count);
@@ -3358,7 +3357,7 @@ bool check_builtin_procedure(Checker *c, Operand *operand, AstNode *call, i32 id
 		}
 	}
 
-	bool vari_expand = (ce->ellipsis.pos.line != 0);
+	bool vari_expand = (ce->ellipsis.pos.file_id != 0);
 	if (vari_expand && id != BuiltinProc_append) {
 		error(ce->ellipsis, "Invalid use of `..` with built-in procedure `append`");
 		return false;
@@ -4543,7 +4542,7 @@ CallArgumentError check_call_arguments_internal(Checker *c, AstNode *call, Type
 	ast_node(ce, CallExpr, call);
 	isize param_count = 0;
 	bool variadic = proc_type->Proc.variadic;
-	bool vari_expand = (ce->ellipsis.pos.line != 0);
+	bool vari_expand = (ce->ellipsis.pos.file_id != 0);
 	i64 score = 0;
 	bool show_error = show_error_mode == CallArgumentMode_ShowErrors;
 
@@ -4696,6 +4695,119 @@ bool check_unpack_arguments(Checker *c, isize lhs_count, ArrayOperand *operands,
 	return optional_ok;
 }
 
+// NOTE: The parameter count that `check_call_arguments_internal` checks the arguments against
+isize overload__arity(Type *proc_type) {
+	if (proc_type->Proc.params == NULL) {
+		return 0;
+	}
+	isize param_count = proc_type->Proc.params->Tuple.variable_count;
+	if (proc_type->Proc.variadic) {
+		param_count--;
+	}
+	return param_count;
+}
+
+// NOTE: The candidates must have been checked
+OverloadSet *make_overload_set(Entity **procs, isize proc_count) {
+	gbAllocator a = heap_allocator();
+	OverloadSet *set = gb_alloc_item(a, OverloadSet);
+	set->procs      = gb_alloc_array(a, Entity *, proc_count);
+	set->proc_count = proc_count;
+	gb_memmove(set->procs, procs, proc_count*gb_size_of(Entity *));
+	array_init(&set->variadic, a);
+	map_overload_memo_init(&set->memos, a);
+
+	set->max_arity = -1;
+	for (isize i = 0; i < proc_count; i++) {
+		Type *t = base_type(procs[i]->type);
+		if (t != NULL && is_type_proc(t) && !t->Proc.variadic) {
+			set->max_arity = gb_max(set->max_arity, overload__arity(t));
+		}
+	}
+	set->fixed = gb_alloc_array(a, Array_isize, set->max_arity+1);
+	for (isize i = 0; i <= set->max_arity; i++) {
+		array_init(&set->fixed[i], a);
+	}
+
+	for (isize i = 0; i < proc_count; i++) {
+		Type *t = base_type(procs[i]->type);
+		if (t == NULL || !is_type_proc(t)) {
+			continue;
+		}
+		if (t->Proc.variadic) {
+			array_add(&set->variadic, i);
+		} else {
+			array_add(&set->fixed[overload__arity(t)], i);
+		}
+	}
+	return set;
+}
+
+OverloadSet *overload_set_of(Entity **procs, isize proc_count, bool create) {
+	HashKey key = hashing_proc(procs, proc_count*gb_size_of(Entity *));
+
+	gb_mutex_lock(&overload_cache.mutex);
+	MapOverloadSetEntry *e = map_overload_set_multi_find_first(&overload_cache.sets, key);
+	while (e != NULL) {
+		OverloadSet *set = e->value;
+		if (set->proc_count == proc_count &&
+		    gb_memcompare(set->procs, procs, proc_count*gb_size_of(Entity *)) == 0) {
+			break;
+		}
+		e = map_overload_set_multi_find_next(&overload_cache.sets, e);
+	}
+	OverloadSet *set = NULL;
+	if (e != NULL) {
+		set = e->value;
+	} else if (create) {
+		set = make_overload_set(procs, proc_count);
+		map_overload_set_multi_insert(&overload_cache.sets, key, set);
+	}
+	gb_mutex_unlock(&overload_cache.mutex);
+	return set;
+}
+
+// NOTE: An untyped argument depends on its value too, e.g. whether a constant is representable
+bool overload_call_can_be_memoized(Operand *operands, isize operand_count) {
+	for (isize i = 0; i < operand_count; i++) {
+		Operand *o = &operands[i];
+		if (o->mode == Addressing_Invalid || o->mode == Addressing_Builtin ||
+		    o->type == NULL || o->type == t_invalid || is_type_untyped(o->type)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+HashKey overload_memo_key(Operand *operands, isize operand_count, bool vari_expand) {
+	u64 h = 14695981039346656037ull;
+	for (isize i = 0; i < operand_count; i++) {
+		h = (h ^ cast(u64)cast(uintptr)operands[i].type) * 1099511628211ull;
+	}
+	h = (h ^ cast(u64)vari_expand) * 1099511628211ull;
+	HashKey key = {HashKey_Default};
+	key.key = h;
+	return key;
+}
+
+OverloadMemo *overload_memo_of(OverloadSet *set, HashKey key, Operand *operands, isize operand_count, bool vari_expand) {
+	MapOverloadMemoEntry *e = map_overload_memo_multi_find_first(&set->memos, key);
+	for (; e != NULL; e = map_overload_memo_multi_find_next(&set->memos, e)) {
+		OverloadMemo *m = e->value;
+		if (m->arg_count != operand_count || m->vari_expand != vari_expand) {
+			continue;
+		}
+		isize i = 0;
+		while (i < operand_count && m->arg_types[i] == operands[i].type) {
+			i++;
+		}
+		if (i == operand_count) {
+			return m;
+		}
+	}
+	return NULL;
+}
+
 Type *check_call_arguments(Checker *c, Operand *operand, Type *proc_type, AstNode *call) {
 	GB_ASSERT(call->kind == AstNode_CallExpr);
 
@@ -4716,18 +4828,57 @@ Type *check_call_arguments(Checker *c, Operand *operand, Type *proc_type, AstNod
 
 		String name = procs[0]->token.string;
 
-		for (isize i = 0; i < overload_count; i++) {
-			Entity *e = procs[i];
-			DeclInfo **found = map_decl_info_get(&c->info.entities, hash_pointer(e));
-			GB_ASSERT(found != NULL);
-			DeclInfo *d = *found;
-			check_entity_decl(c, e, d, NULL);
-		}
-
-		for (isize i = 0; i < overload_count; i++) {
-			Entity *p = procs[i];
-			Type *proc_type = base_type(p->type);
-			if (proc_type != NULL && is_type_proc(proc_type)) {
+		// NOTE: A set that was called before with the same argument types resolves as it did then,
+		// only what scoring the candidates recorded is replayed
+		bool vari_expand = (ce->ellipsis.pos.file_id != 0);
+		bool memoize = overload_call_can_be_memoized(operands.e, operands.count);
+		HashKey memo_key = overload_memo_key(operands.e, operands.count, vari_expand);
+		OverloadSet *set = overload_set_of(procs, overload_count, false);
+		OverloadMemo *memo = NULL;
+		if (set != NULL && memoize) {
+			gb_mutex_lock(&overload_cache.mutex);
+			memo = overload_memo_of(set, memo_key, operands.e, operands.count, vari_expand);
+			gb_mutex_unlock(&overload_cache.mutex);
+		}
+
+		if (memo != NULL) {
+			for (isize i = 0; i < memo->type_info_count; i++) {
+				add_type_info_type(c, memo->type_infos[i]);
+			}
+			valids[0].index = memo->index;
+			valids[0].score = 0;
+			valid_count = 1;
+		} else {
+			for (isize i = 0; i < overload_count; i++) {
+				Entity *e = procs[i];
+				DeclInfo **found = checker_decl_info_of_entity(c, e);
+				GB_ASSERT(found != NULL);
+				DeclInfo *d = *found;
+				check_entity_decl(c, e, d, NULL);
+			}
+			if (set == NULL) {
+				set = overload_set_of(procs, overload_count, true);
+			}
+
+			TypePtrArray type_infos = {0};
+			array_init(&type_infos, heap_allocator());
+			TypePtrArray *prev_capture = c->type_info_capture;
+			c->type_info_capture = &type_infos;
+
+			// NOTE: Only the candidates that take this many arguments can be valid, and both lists
+			// are in the order of `procs` so the scores are sorted as before
+			Array_isize empty = {0};
+			Array_isize fixed = operands.count <= set->max_arity ? set->fixed[operands.count] : empty;
+			isize fi = 0, vi = 0;
+			while (fi < fixed.count || vi < set->variadic.count) {
+				isize i = 0;
+				if (vi >= set->variadic.count ||
+				    (fi < fixed.count && fixed.e[fi] < set->variadic.e[vi])) {
+					i = fixed.e[fi++];
+				} else {
+					i = set->variadic.e[vi++];
+				}
+				Type *proc_type = base_type(procs[i]->type);
 				i64 score = 0;
 				CallArgumentError err = check_call_arguments_internal(c, call, proc_type, operands.e, operands.count, CallArgumentMode_NoErrors, &score);
 				if (err == CallArgumentError_None) {
@@ -4736,18 +4887,53 @@ Type *check_call_arguments(Checker *c, Operand *operand, Type *proc_type, AstNod
 					valid_count++;
 				}
 			}
-		}
 
-		if (valid_count > 1) {
-			gb_sort_array(valids, valid_count, valid_proc_and_score_cmp);
-			i64 best_score = valids[0].score;
-			for (isize i = 0; i < valid_count; i++) {
-				if (best_score > valids[i].score) {
-					valid_count = i;
-					break;
+			c->type_info_capture = prev_capture;
+			if (prev_capture != NULL) {
+				for_array(i, type_infos) {
+					array_add(prev_capture, type_infos.e[i]);
+				}
+			}
+
+			if (valid_count > 1) {
+				gb_sort_array(valids, valid_count, valid_proc_and_score_cmp);
+				i64 best_score = valids[0].score;
+				for (isize i = 0; i < valid_count; i++) {
+					if (best_score > valids[i].score) {
+						valid_count = i;
+						break;
+					}
+					best_score = valids[i].score;
+				}
+			}
+
+			if (memoize && valid_count == 1) {
+				gbAllocator a = heap_allocator();
+				OverloadMemo *m = gb_alloc_item(a, OverloadMemo);
+				m->arg_count       = operands.count;
+				m->arg_types       = gb_alloc_array(a, Type *, gb_max(operands.count, 1));
+				m->vari_expand     = vari_expand;
+				m->index           = valids[0].index;
+				m->type_info_count = type_infos.count;
+				m->type_infos      = type_infos.e;
+				type_infos.e = NULL;
+				for_array(i, operands) {
+					m->arg_types[i] = operands.e[i].type;
+				}
+
+				gb_mutex_lock(&overload_cache.mutex);
+				if (overload_memo_of(set, memo_key, operands.e, operands.count, vari_expand) == NULL) {
+					map_overload_memo_multi_insert(&set->memos, memo_key, m);
+					m = NULL;
+				}
+				gb_mutex_unlock(&overload_cache.mutex);
+				if (m != NULL) {
+					gb_free(a, m->type_infos);
+					gb_free(a, m->arg_types);
+					gb_free(a, m);
 				}
-				best_score = valids[i].score;
 			}
+			array_free(&type_infos);
 		}
 
 
@@ -4760,7 +4946,7 @@ Type *check_call_arguments(Checker *c, Operand *operand, Type *proc_type, AstNod
 				Entity *proc = procs[valids[i].index];
 				TokenPos pos = proc->token.pos;
 				gbString pt = type_to_string(proc->type);
-				gb_printf_err("\t%.*s :: %s at %.*s(%td:%td)\n", LIT(name), pt, LIT(pos.file), pos.line, pos.column);
+				error_line("\t%.*s :: %s at %.*s(%td:%td)\n", LIT(name), pt, LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 				gb_string_free(pt);
 			}
 			proc_type = t_invalid;
@@ -5052,10 +5238,10 @@ ExprKind check_expr_base_internal(Checker *c, Operand *o, AstNode *node, Type *t
 	case_ast_node(bd, BasicDirective, node);
 		if (str_eq(bd->name, str_lit("file"))) {
 			o->type = t_untyped_string;
-			o->value = exact_value_string(bd->token.pos.file);
+			o->value = exact_value_string(token_pos_file(bd->token.pos));
 		} else if (str_eq(bd->name, str_lit("line"))) {
 			o->type = t_untyped_integer;
-			o->value = exact_value_i64(bd->token.pos.line);
+			o->value = exact_value_i64(token_pos_line(bd->token.pos));
 		} else if (str_eq(bd->name, str_lit("procedure"))) {
 			if (c->proc_stack.count == 0) {
 				error_node(node, "#procedure may only be used within procedures");
@@ -5392,7 +5578,7 @@ ExprKind check_expr_base_internal(Checker *c, Operand *o, AstNode *node, Type *t
 			}
 
 			if (t->kind == Type_Array && is_to_be_determined_array_count) {
-				t->Array.count = max;
+				type = make_type_array(c->allocator, t->Array.elem, max); // NOTE: Array types are interned and never changed
 			}
 		} break;
 
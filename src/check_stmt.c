@@ -239,7 +239,7 @@ Type *check_assignment_variable(Checker *c, Operand *rhs, AstNode *lhs_node) {
 	} else {
 		if (node->kind == AstNode_Ident) {
 			ast_node(i, Ident, node);
-			e = scope_lookup_entity(c->context.scope, i->string);
+			e = scope_lookup_entity(c->context.scope, hash_token(*i));
 			if (e != NULL && e->kind == Entity_Variable) {
 				used = (e->flags & EntityFlag_Used) != 0; // TODO(bill): Make backup just in case
 			}
@@ -248,7 +248,7 @@ Type *check_assignment_variable(Checker *c, Operand *rhs, AstNode *lhs_node) {
 	}
 
 	if (e != NULL && used) {
-		e->flags |= EntityFlag_Used;
+		set_entity_used(c, e);
 	}
 
 	Type *assignment_type = lhs.type;
@@ -457,7 +457,7 @@ bool check_using_stmt_entity(Checker *c, AstNodeUsingStmt *us, AstNode *expr, bo
 					gb_string_free(expr_str);
 					return false;
 				}
-				f->using_parent = e;
+				scope_add_using_parent(c->context.scope, f, e);
 			}
 		} else if (is_type_enum(t)) {
 			for (isize i = 0; i < t->Record.field_count; i++) {
@@ -469,7 +469,7 @@ bool check_using_stmt_entity(Checker *c, AstNodeUsingStmt *us, AstNode *expr, bo
 					gb_string_free(expr_str);
 					return false;
 				}
-				f->using_parent = e;
+				scope_add_using_parent(c->context.scope, f, e);
 			}
 
 		} else {
@@ -489,8 +489,8 @@ bool check_using_stmt_entity(Checker *c, AstNodeUsingStmt *us, AstNode *expr, bo
 				      "\tat %.*s(%td:%td)\n"
 				      "\tat %.*s(%td:%td)",
 				      expr_str, LIT(found->token.string),
-				      LIT(found->token.pos.file), found->token.pos.line, found->token.pos.column,
-				      LIT(decl->token.pos.file), decl->token.pos.line, decl->token.pos.column
+				      LIT(token_pos_file(found->token.pos)), token_pos_line(found->token.pos), token_pos_column(found->token.pos),
+				      LIT(token_pos_file(decl->token.pos)), token_pos_line(decl->token.pos), token_pos_column(decl->token.pos)
 				      );
 				gb_string_free(expr_str);
 				return false;
@@ -502,9 +502,8 @@ bool check_using_stmt_entity(Checker *c, AstNodeUsingStmt *us, AstNode *expr, bo
 		Type *t = base_type(type_deref(e->type));
 		if (is_type_struct(t) || is_type_raw_union(t) || is_type_union(t)) {
 			// TODO(bill): Make it work for unions too
-			Scope **found_ = map_scope_get(&c->info.scopes, hash_pointer(t->Record.node));
-			GB_ASSERT(found_ != NULL);
-			Scope *found = *found_;
+			Scope *found = scope_of_node(&c->info, t->Record.node);
+			GB_ASSERT(found != NULL);
 			for_array(i, found->elements.entries) {
 				Entity *f = found->elements.entries.e[i].value;
 				if (f->kind == Entity_Variable) {
@@ -626,14 +625,12 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 			return;
 		}
 		AstNode *left = s->expr;
-		AstNode *right = gb_alloc_item(c->allocator, AstNode);
-		right->kind = AstNode_BasicLit;
+		AstNode *right = alloc_ast_node(c->allocator, AstNode_BasicLit);
 		right->BasicLit.pos = s->op.pos;
 		right->BasicLit.kind = Token_Integer;
 		right->BasicLit.string = str_lit("1");
 
-		AstNode *be = gb_alloc_item(c->allocator, AstNode);
-		be->kind = AstNode_BinaryExpr;
+		AstNode *be = alloc_ast_node(c->allocator, AstNode_BinaryExpr);
 		be->BinaryExpr.op = s->op;
 		be->BinaryExpr.op.kind = op;
 		be->BinaryExpr.left = left;
@@ -777,12 +774,12 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 				error_node(node, "Expected %td return values, got 0", result_count);
 			} else {
 				// TokenPos pos = rs->token.pos;
-				// if (pos.line == 10) {
+				// if (token_pos_line(pos) == 10) {
 				// 	gb_printf_err("%s\n", type_to_string(variables[0]->type));
 				// }
 				check_init_variables(c, variables, result_count,
 				                     rs->results, str_lit("return statement"));
-				// if (pos.line == 10) {
+				// if (token_pos_line(pos) == 10) {
 				// 	AstNode *x = rs->results.e[0];
 				// 	gb_printf_err("%s\n", expr_to_string(x));
 				// 	gb_printf_err("%s\n", type_to_string(type_of_expr(&c->info, x)));
@@ -1000,7 +997,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 				Entity *found = NULL;
 
 				if (str_ne(str, str_lit("_"))) {
-					found = current_scope_lookup_entity(c->context.scope, str);
+					found = current_scope_lookup_entity(c->context.scope, hash_token(token));
 				}
 				if (found == NULL) {
 					entity = make_entity_variable(c->allocator, c->context.scope, token, type, true);
@@ -1010,7 +1007,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 					error(token,
 					      "Redeclaration of `%.*s` in this scope\n"
 					      "\tat %.*s(%td:%td)",
-					      LIT(str), LIT(pos.file), pos.line, pos.column);
+					      LIT(str), LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 					entity = found;
 				}
 			} else {
@@ -1059,7 +1056,8 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 			Token token  = {0};
 			token.pos    = ast_node_token(ms->body).pos;
 			token.string = str_lit("true");
-			x.expr       = ast_ident(c->curr_ast_file, token);
+			x.expr       = alloc_ast_node(c->allocator, AstNode_Ident);
+			x.expr->Ident = token;
 		}
 		if (is_type_vector(x.type)) {
 			gbString str = type_to_string(x.type);
@@ -1090,7 +1088,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 					error_node(stmt,
 					           "multiple `default` clauses\n"
 					           "\tfirst at %.*s(%td:%td)",
-					           LIT(pos.file), pos.line, pos.column);
+					           LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 				} else {
 					first_default = default_stmt;
 				}
@@ -1207,7 +1205,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 									           "Duplicate case `%s`\n"
 									           "\tprevious case at %.*s(%td:%td)",
 									           expr_str,
-									           LIT(pos.file), pos.line, pos.column);
+									           LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 									gb_string_free(expr_str);
 									continue_outer = true;
 									break;
@@ -1299,7 +1297,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 					TokenPos pos = ast_node_token(first_default).pos;
 					error_node(stmt,
 					           "Multiple `default` clauses\n"
-					           "\tfirst at %.*s(%td:%td)", LIT(pos.file), pos.line, pos.column);
+					           "\tfirst at %.*s(%td:%td)", LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 				} else {
 					first_default = default_stmt;
 				}
@@ -1366,7 +1364,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 						           "Duplicate type case `%s`\n"
 						           "\tprevious type case at %.*s(%td:%td)",
 						           expr_str,
-						           LIT(pos.file), pos.line, pos.column);
+						           LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 						gb_string_free(expr_str);
 						break;
 					}
@@ -1532,7 +1530,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 					Entity *found = NULL;
 					// NOTE(bill): Ignore assignments to `_`
 					if (str_ne(str, str_lit("_"))) {
-						found = current_scope_lookup_entity(c->context.scope, str);
+						found = current_scope_lookup_entity(c->context.scope, hash_token(token));
 					}
 					if (found == NULL) {
 						entity = make_entity_variable(c->allocator, c->context.scope, token, NULL, vd->flags&VarDeclFlag_immutable);
@@ -1542,7 +1540,7 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 						error(token,
 						      "Redeclaration of `%.*s` in this scope\n"
 						      "\tat %.*s(%td:%td)",
-						      LIT(str), LIT(pos.file), pos.line, pos.column);
+						      LIT(str), LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 						entity = found;
 					}
 				}
@@ -1602,10 +1600,10 @@ void check_stmt_internal(Checker *c, AstNode *node, u32 flags) {
 					Type *t = base_type(type_deref(e->type));
 
 					if (is_type_struct(t) || is_type_raw_union(t)) {
-						Scope **found = map_scope_get(&c->info.scopes, hash_pointer(t->Record.node));
+						Scope *found = scope_of_node(&c->info, t->Record.node);
 						GB_ASSERT(found != NULL);
-						for_array(i, (*found)->elements.entries) {
-							Entity *f = (*found)->elements.entries.e[i].value;
+						for_array(i, found->elements.entries) {
+							Entity *f = found->elements.entries.e[i].value;
 							if (f->kind == Entity_Variable) {
 								Entity *uvar = make_entity_using_variable(c->allocator, e, f->token, f->type);
 								uvar->Variable.is_immutable = is_immutable;
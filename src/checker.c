@@ -196,7 +196,7 @@ struct DeclInfo {
 	AstNode *         init_expr;
 	AstNode *         proc_lit; // AstNode_ProcLit
 
-	MapBool           deps; // Key: Entity *
+	EntityArray       deps; // NOTE: May repeat entities, see `compact_dependencies`
 	Array(BlockLabel) labels;
 };
 
@@ -232,6 +232,17 @@ ExprInfo make_expr_info(bool is_lhs, AddressingMode mode, Type *type, ExactValue
 #define MAP_NAME MapEntity
 #include "map.c"
 
+// NOTE: What a lookup finds and the scope that it was found in
+typedef struct ScopeLookup {
+	Entity *entity;
+	Scope * scope;
+} ScopeLookup;
+
+#define MAP_TYPE ScopeLookup
+#define MAP_PROC map_scope_lookup_
+#define MAP_NAME MapScopeLookup
+#include "map.c"
+
 typedef struct Scope {
 	Scope *          parent;
 	Scope *          prev, *next;
@@ -239,6 +250,10 @@ typedef struct Scope {
 	Scope *          last_child;
 	MapEntity        elements; // Key: String
 	MapBool          implicit; // Key: Entity *
+	// NOTE: The entity a union variant or enum field was brought in through by `using`. These
+	// belong to their type and are shared, so this is kept here rather than in `using_parent`
+	MapEntity        using_parents; // Key: Entity *
+	bool             has_using_parents;
 
 	Array(Scope *)   shared;
 	Array(Scope *)   imported;
@@ -248,6 +263,10 @@ typedef struct Scope {
 	bool             is_init;
 	bool             has_been_imported; // This is only applicable to file scopes
 	AstFile *        file;
+
+	// NOTE: File scopes only, see `build_scope_lookup_table`
+	MapScopeLookup   lookup; // Key: String
+	bool             has_lookup;
 } Scope;
 gb_global Scope *universal_scope = NULL;
 
@@ -255,11 +274,6 @@ gb_global Scope *universal_scope = NULL;
 
 
 
-#define MAP_TYPE TypeAndValue
-#define MAP_PROC map_tav_
-#define MAP_NAME MapTypeAndValue
-#include "map.c"
-
 #define MAP_TYPE Scope *
 #define MAP_PROC map_scope_
 #define MAP_NAME MapScope
@@ -305,19 +319,42 @@ typedef struct CheckerContext {
 
 // CheckerInfo stores all the symbol information for a type-checked program
 typedef struct CheckerInfo {
-	MapTypeAndValue      types;           // Key: AstNode * | Expression -> Type (and value)
-	MapEntity            definitions;     // Key: AstNode * | Identifier -> Entity
-	MapEntity            uses;            // Key: AstNode * | Identifier -> Entity
-	MapScope             scopes;          // Key: AstNode * | Node       -> Scope
+	// NOTE: What is recorded for a node is indexed by its id (see ast_node_id). The tables are
+	// allocated once every file is parsed, as they never grow, and are shared with the workers.
+	isize *              node_bases;      // Key: token file id | The id of the first node of the file
+	isize                node_count;
+	TypeAndValue *       types;           // Expression -> Type (and value)
+	Entity **            definitions;     // Identifier -> Entity
+	Entity **            uses;            // Identifier -> Entity
+	Scope **             scopes;          // Node       -> Scope
+	Entity **            implicits;
+
 	MapExprInfo          untyped;         // Key: AstNode * | Expression -> ExprInfo
 	MapDeclInfo          entities;        // Key: Entity *
-	MapEntity            implicits;       // Key: AstNode *
 	MapEntity            foreigns;        // Key: String
 	MapAstFile           files;           // Key: String (full path)
 	MapIsize             type_info_map;   // Key: Type *
 	isize                type_info_count;
 } CheckerInfo;
 
+// NOTE: -1 if nothing is recorded for the node (see alloc_ast_node)
+gb_inline isize ast_node_id(CheckerInfo *i, AstNode *node) {
+	if (node->file_id == 0) {
+		return -1;
+	}
+	return i->node_bases[node->file_id] + node->index;
+}
+
+// NOTE: What a worker allocates outlives the wave it was checked in, so it is taken from what is
+// left of the main arena in blocks rather than each worker having an arena as large as it
+typedef struct CheckerWorkerArena {
+	gbArena *parent; // NOTE: Guarded by `checker_mutex`
+	u8 *     curr;
+	u8 *     end;
+} CheckerWorkerArena;
+
+#define CHECKER_WORKER_ARENA_BLOCK_SIZE gb_kilobytes(64)
+
 typedef struct Checker {
 	Parser *    parser;
 	CheckerInfo info;
@@ -331,6 +368,7 @@ typedef struct Checker {
 
 	gbArena                arena;
 	gbArena                tmp_arena;
+	CheckerWorkerArena     worker_arena; // NOTE: `arena` is not used by the workers
 	gbAllocator            allocator;
 	gbAllocator            tmp_allocator;
 
@@ -338,8 +376,72 @@ typedef struct Checker {
 
 	Array(Type *)          proc_stack;
 	bool                   done_preload;
+
+	// NOTE: Only set on the copies that check procedure bodies in parallel (see check_proc_bodies).
+	// These record into `info` and look up what was recorded before the bodies in `shared_info`.
+	CheckerInfo *          shared_info;
+	Array(Type *)          type_info_queue; // NOTE: Replayed in order when the results are merged
+	EntityArray            unnumbered_entities;
+	EntityArray            used_entities; // NOTE: Shared entities to mark as used when merged
+
+	// NOTE: While set, what is given to `add_type_info_type` is also appended to it
+	TypePtrArray *         type_info_capture;
+
+	Array(struct Checker *) workers;
 } Checker;
 
+// NOTE: Where the results of one procedure body start in the maps and queues of a worker, what
+// is recorded for its nodes is written to the shared node tables directly
+typedef struct CheckerProcMark {
+	isize untyped, entities;
+	isize type_infos, procs, unnumbered_entities, used_entities;
+} CheckerProcMark;
+
+typedef struct CheckedProc {
+	Checker *       worker;
+	CheckerProcMark start;
+	CheckerProcMark end;
+} CheckedProc;
+
+gb_global gbMutex checker_mutex; // NOTE: Guards what the workers checking procedure bodies share
+
+// NOTE: How a call to a set of overloaded procedures resolved for each tuple of argument types,
+// see `check_call_arguments`
+typedef struct OverloadMemo {
+	Type ** arg_types;
+	isize   arg_count;
+	bool    vari_expand;
+	isize   index;      // NOTE: Of the procedure it resolved to
+	Type ** type_infos; // NOTE: What scoring the candidates gave `add_type_info_type`, in order
+	isize   type_info_count;
+} OverloadMemo;
+
+#define MAP_TYPE OverloadMemo *
+#define MAP_PROC map_overload_memo_
+#define MAP_NAME MapOverloadMemo
+#include "map.c"
+
+typedef struct OverloadSet {
+	Entity **       procs;
+	isize           proc_count;
+	Array_isize *   fixed;     // NOTE: [arity] -> the candidates that take exactly that many arguments
+	isize           max_arity;
+	Array_isize     variadic;  // NOTE: The variadic candidates, in the same order as `procs`
+	MapOverloadMemo memos;     // Key: hash of the argument types
+} OverloadSet;
+
+#define MAP_TYPE OverloadSet *
+#define MAP_PROC map_overload_set_
+#define MAP_NAME MapOverloadSet
+#include "map.c"
+
+typedef struct OverloadCache {
+	gbMutex        mutex;
+	MapOverloadSet sets; // Key: hash of the candidates
+} OverloadCache;
+
+gb_global OverloadCache overload_cache = {0};
+
 
 typedef struct DelayedEntity {
 	AstNode *   ident;
@@ -355,8 +457,8 @@ typedef Array(DelayedEntity) DelayedEntities;
 void init_declaration_info(DeclInfo *d, Scope *scope, DeclInfo *parent) {
 	d->parent = parent;
 	d->scope  = scope;
-	map_bool_init(&d->deps, heap_allocator());
-	array_init(&d->labels,  heap_allocator());
+	array_init(&d->deps,    tagged_allocator(MemoryTag_CheckerMaps));
+	array_init(&d->labels,  tagged_allocator(MemoryTag_CheckerMaps));
 }
 
 DeclInfo *make_declaration_info(gbAllocator a, Scope *scope, DeclInfo *parent) {
@@ -366,7 +468,7 @@ DeclInfo *make_declaration_info(gbAllocator a, Scope *scope, DeclInfo *parent) {
 }
 
 void destroy_declaration_info(DeclInfo *d) {
-	map_bool_destroy(&d->deps);
+	array_free(&d->deps);
 }
 
 bool decl_info_has_init(DeclInfo *d) {
@@ -393,10 +495,10 @@ bool decl_info_has_init(DeclInfo *d) {
 Scope *make_scope(Scope *parent, gbAllocator allocator) {
 	Scope *s = gb_alloc_item(allocator, Scope);
 	s->parent = parent;
-	map_entity_init(&s->elements,   heap_allocator());
-	map_bool_init(&s->implicit,     heap_allocator());
-	array_init(&s->shared,          heap_allocator());
-	array_init(&s->imported,        heap_allocator());
+	map_entity_init(&s->elements,   tagged_allocator(MemoryTag_Scopes));
+	map_bool_init(&s->implicit,     tagged_allocator(MemoryTag_Scopes));
+	array_init(&s->shared,          tagged_allocator(MemoryTag_Scopes));
+	array_init(&s->imported,        tagged_allocator(MemoryTag_Scopes));
 
 	if (parent != NULL && parent != universal_scope) {
 		DLIST_APPEND(parent->first_child, parent->last_child, s);
@@ -404,6 +506,24 @@ Scope *make_scope(Scope *parent, gbAllocator allocator) {
 	return s;
 }
 
+void scope_add_using_parent(Scope *s, Entity *e, Entity *parent) {
+	if (!s->has_using_parents) {
+		map_entity_init(&s->using_parents, tagged_allocator(MemoryTag_Scopes));
+		s->has_using_parents = true;
+	}
+	map_entity_set(&s->using_parents, hash_pointer(e), parent);
+}
+
+Entity *scope_using_parent(Scope *s, Entity *e) {
+	if (s->has_using_parents) {
+		Entity **found = map_entity_get(&s->using_parents, hash_pointer(e));
+		if (found != NULL) {
+			return *found;
+		}
+	}
+	return NULL;
+}
+
 void destroy_scope(Scope *scope) {
 	for_array(i, scope->elements.entries) {
 		Entity *e =scope->elements.entries.e[i].value;
@@ -424,14 +544,47 @@ void destroy_scope(Scope *scope) {
 	map_bool_destroy(&scope->implicit);
 	array_free(&scope->shared);
 	array_free(&scope->imported);
+	if (scope->has_lookup) {
+		map_scope_lookup_destroy(&scope->lookup);
+	}
+	if (scope->has_using_parents) {
+		map_entity_destroy(&scope->using_parents);
+	}
 
 	// NOTE(bill): No need to free scope as it "should" be allocated in an arena (except for the global scope)
 }
 
+DeclInfo **checker_decl_info_of_entity(Checker *c, Entity *e) {
+	DeclInfo **found = map_decl_info_get(&c->info.entities, hash_pointer(e));
+	if (found == NULL && c->shared_info != NULL) {
+		found = map_decl_info_get(&c->shared_info->entities, hash_pointer(e));
+	}
+	return found;
+}
+
+// NOTE: Foreign and link names are shared by the workers, as the first procedure to declare one
+// is the one the others are compared against
+MapEntity *checker_lock_foreigns(Checker *c) {
+	if (c->shared_info == NULL) {
+		return &c->info.foreigns;
+	}
+	gb_mutex_lock(&checker_mutex);
+	return &c->shared_info->foreigns;
+}
+
+void checker_unlock_foreigns(Checker *c) {
+	if (c->shared_info != NULL) {
+		gb_mutex_unlock(&checker_mutex);
+	}
+}
+
 void add_scope(Checker *c, AstNode *node, Scope *scope) {
 	GB_ASSERT(node != NULL);
 	GB_ASSERT(scope != NULL);
-	map_scope_set(&c->info.scopes, hash_pointer(node), scope);
+	isize id = ast_node_id(&c->info, node);
+	if (id >= 0) {
+		c->info.scopes[id] = scope;
+	}
 }
 
 
@@ -439,6 +592,7 @@ void check_open_scope(Checker *c, AstNode *node) {
 	GB_ASSERT(node != NULL);
 	node = unparen_expr(node);
 	GB_ASSERT(node->kind == AstNode_Invalid ||
+	          node->kind == AstNode_UnionField ||
 	          is_ast_node_stmt(node) ||
 	          is_ast_node_type(node));
 	Scope *scope = make_scope(c->context.scope, c->allocator);
@@ -455,8 +609,7 @@ void check_close_scope(Checker *c) {
 }
 
 
-Entity *current_scope_lookup_entity(Scope *s, String name) {
-	HashKey key = hash_string(name);
+Entity *current_scope_lookup_entity(Scope *s, HashKey key) {
 	Entity **found = map_entity_get(&s->elements, key);
 	if (found) {
 		return *found;
@@ -483,11 +636,23 @@ Entity *current_scope_lookup_entity(Scope *s, String name) {
 	return NULL;
 }
 
-void scope_lookup_parent_entity(Scope *scope, String name, Scope **scope_, Entity **entity_) {
+// NOTE: Set once a global level scope gains an entity after the lookup tables were built, from
+// which point every lookup walks the scopes again
+gb_global bool scope_lookup_tables_built = false;
+gb_global bool scope_lookup_tables_stale = false;
+
+void scope_lookup_parent_entity(Scope *scope, HashKey key, Scope **scope_, Entity **entity_) {
 	bool gone_thru_proc = false;
 	bool gone_thru_file = false;
-	HashKey key = hash_string(name);
 	for (Scope *s = scope; s != NULL; s = s->parent) {
+		if (s->has_lookup && !scope_lookup_tables_stale) {
+			// NOTE: The table covers everything from here up to the universal scope
+			ScopeLookup *found = map_scope_lookup_get(&s->lookup, key);
+			if (entity_) *entity_ = found ? found->entity : NULL;
+			if (scope_)  *scope_  = found ? found->scope  : NULL;
+			return;
+		}
+
 		Entity **found = map_entity_get(&s->elements, key);
 		if (found) {
 			Entity *e = *found;
@@ -550,19 +715,101 @@ void scope_lookup_parent_entity(Scope *scope, String name, Scope **scope_, Entit
 	if (scope_) *scope_ = NULL;
 }
 
-Entity *scope_lookup_entity(Scope *s, String name) {
+Entity *scope_lookup_entity(Scope *s, HashKey key) {
 	Entity *entity = NULL;
-	scope_lookup_parent_entity(s, name, NULL, &entity);
+	scope_lookup_parent_entity(s, key, NULL, &entity);
 	return entity;
 }
 
+void scope_lookup__add(MapScopeLookup *lookup, HashKey key, Entity *e, Scope *s) {
+	if (map_scope_lookup_get(lookup, key) == NULL) {
+		ScopeLookup l = {e, s};
+		map_scope_lookup_set(lookup, key, l);
+	}
+}
+
+// NOTE: Merges everything that `scope_lookup_parent_entity` could find from `file_scope` into one
+// table, in the order the walk would find it and with the same filters, so a lookup of a global
+// name is a single probe rather than one per scope and per #shared_global_scope file
+void build_scope_lookup_table(Scope *file_scope) {
+	GB_ASSERT(file_scope->is_file);
+	if (file_scope->has_lookup) {
+		map_scope_lookup_destroy(&file_scope->lookup);
+		file_scope->has_lookup = false;
+	}
+
+	isize capacity = 0;
+	for (Scope *s = file_scope; s != NULL; s = s->parent) {
+		capacity += s->elements.entries.count;
+		for_array(i, s->shared) {
+			capacity += s->shared.e[i]->elements.entries.count;
+		}
+	}
+
+	MapScopeLookup lookup = {0};
+	map_scope_lookup_init(&lookup, tagged_allocator(MemoryTag_Scopes));
+	map_scope_lookup_reserve(&lookup, capacity);
+
+	bool gone_thru_file = false;
+	for (Scope *s = file_scope; s != NULL; s = s->parent) {
+		GB_ASSERT(!s->is_proc);
+		for_array(i, s->elements.entries) {
+			HashKey key = s->elements.entries.e[i].key;
+			// NOTE: Of the overloads of a name, the walk finds the same one as `get`
+			Entity *e = *map_entity_get(&s->elements, key);
+			scope_lookup__add(&lookup, key, e, s);
+		}
+
+		for_array(j, s->shared) {
+			Scope *shared = s->shared.e[j];
+			for_array(i, shared->elements.entries) {
+				HashKey key = shared->elements.entries.e[i].key;
+				Entity *e = *map_entity_get(&shared->elements, key);
+				if (e->kind == Entity_Variable &&
+				    !e->scope->is_file &&
+				    !e->scope->is_global) {
+					continue;
+				}
+				if (e->scope != shared) {
+					continue;
+				}
+				if ((e->kind == Entity_ImportName ||
+				     e->kind == Entity_LibraryName)
+				     && gone_thru_file) {
+					continue;
+				}
+				scope_lookup__add(&lookup, key, e, shared);
+			}
+		}
+
+		if (s->is_file) {
+			gone_thru_file = true;
+		}
+	}
+
+	file_scope->lookup     = lookup;
+	file_scope->has_lookup = true;
+	scope_lookup_tables_built = true;
+}
+
 
 
 Entity *scope_insert_entity(Scope *s, Entity *entity) {
-	String name = entity->token.string;
-	HashKey key = hash_string(name);
+	HashKey key = hash_token(entity->token);
 	Entity **found = map_entity_get(&s->elements, key);
 
+	if (scope_lookup_tables_built) {
+		if (s->is_file && !s->is_global) {
+			if (s->has_lookup) {
+				map_scope_lookup_destroy(&s->lookup);
+				s->has_lookup = false;
+			}
+		} else if (s->is_global || s->parent == NULL || s->parent == universal_scope) {
+			// NOTE: Any file's table may need this name
+			scope_lookup_tables_stale = true;
+		}
+	}
+
 #if 1
 	// IMPORTANT NOTE(bill): Procedure overloading code
 	Entity *prev = NULL;
@@ -602,7 +849,19 @@ void check_scope_usage(Checker *c, Scope *scope) {
 
 
 void add_dependency(DeclInfo *d, Entity *e) {
-	map_bool_set(&d->deps, hash_pointer(e), cast(bool)true);
+	if (d->deps.count > 0 && d->deps.e[d->deps.count-1] == e) {
+		return;
+	}
+	array_add(&d->deps, e);
+}
+
+// NOTE(bill): Add the dependencies from the procedure literal (lambda)
+void add_dependencies_to_parent(DeclInfo *d) {
+	if (d->parent != NULL) {
+		for_array(i, d->deps) {
+			add_dependency(d->parent, d->deps.e[i]);
+		}
+	}
 }
 
 void add_declaration_dependency(Checker *c, Entity *e) {
@@ -610,7 +869,7 @@ void add_declaration_dependency(Checker *c, Entity *e) {
 		return;
 	}
 	if (c->context.decl != NULL) {
-		DeclInfo **found = map_decl_info_get(&c->info.entities, hash_pointer(e));
+		DeclInfo **found = checker_decl_info_of_entity(c, e);
 		if (found) {
 			add_dependency(c->context.decl, e);
 		}
@@ -649,6 +908,12 @@ Type *add_global_type_alias(gbAllocator a, String name, Type *t) {
 
 void init_universal_scope(void) {
 	BuildContext *bc = &build_context;
+	gb_mutex_init(&checker_mutex);
+	gb_mutex_init(&type_offsets_mutex);
+	init_type_intern_table();
+	gb_mutex_init(&overload_cache.mutex);
+	map_overload_set_init(&overload_cache.sets, heap_allocator());
+
 	// NOTE(bill): No need to free these
 	gbAllocator a = heap_allocator();
 	universal_scope = make_scope(NULL, a);
@@ -707,15 +972,10 @@ void init_universal_scope(void) {
 
 
 void init_checker_info(CheckerInfo *i) {
-	gbAllocator a = heap_allocator();
-	map_tav_init(&i->types,            a);
-	map_entity_init(&i->definitions,   a);
-	map_entity_init(&i->uses,          a);
-	map_scope_init(&i->scopes,         a);
+	gbAllocator a = tagged_allocator(MemoryTag_CheckerMaps);
 	map_decl_info_init(&i->entities,   a);
 	map_expr_info_init(&i->untyped,    a);
 	map_entity_init(&i->foreigns,      a);
-	map_entity_init(&i->implicits,     a);
 	map_isize_init(&i->type_info_map,  a);
 	map_ast_file_init(&i->files,       a);
 	i->type_info_count = 0;
@@ -723,18 +983,49 @@ void init_checker_info(CheckerInfo *i) {
 }
 
 void destroy_checker_info(CheckerInfo *i) {
-	map_tav_destroy(&i->types);
-	map_entity_destroy(&i->definitions);
-	map_entity_destroy(&i->uses);
-	map_scope_destroy(&i->scopes);
 	map_decl_info_destroy(&i->entities);
 	map_expr_info_destroy(&i->untyped);
 	map_entity_destroy(&i->foreigns);
-	map_entity_destroy(&i->implicits);
 	map_isize_destroy(&i->type_info_map);
 	map_ast_file_destroy(&i->files);
 }
 
+void init_checker_node_tables(CheckerInfo *i, Parser *p) {
+	gbAllocator a = tagged_allocator(MemoryTag_CheckerMaps);
+	isize file_id_count = token_files.count;
+	i->node_bases = gb_alloc_array(a, isize, file_id_count);
+	gb_zero_size(i->node_bases, gb_size_of(isize)*file_id_count);
+
+	i->node_count = 0;
+	for_array(j, p->files) {
+		AstFile *f = &p->files.e[j];
+		i->node_bases[f->tokenizer.file_id] = i->node_count;
+		i->node_count += f->node_count;
+	}
+
+	isize n = i->node_count;
+	i->types       = gb_alloc_array(a, TypeAndValue, n);
+	i->definitions = gb_alloc_array(a, Entity *,     n);
+	i->uses        = gb_alloc_array(a, Entity *,     n);
+	i->scopes      = gb_alloc_array(a, Scope *,      n);
+	i->implicits   = gb_alloc_array(a, Entity *,     n);
+	gb_zero_size(i->types,       gb_size_of(TypeAndValue)*n);
+	gb_zero_size(i->definitions, gb_size_of(Entity *)*n);
+	gb_zero_size(i->uses,        gb_size_of(Entity *)*n);
+	gb_zero_size(i->scopes,      gb_size_of(Scope *)*n);
+	gb_zero_size(i->implicits,   gb_size_of(Entity *)*n);
+}
+
+void destroy_checker_node_tables(CheckerInfo *i) {
+	gbAllocator a = tagged_allocator(MemoryTag_CheckerMaps);
+	gb_free(a, i->node_bases);
+	gb_free(a, i->types);
+	gb_free(a, i->definitions);
+	gb_free(a, i->uses);
+	gb_free(a, i->scopes);
+	gb_free(a, i->implicits);
+}
+
 
 void init_checker(Checker *c, Parser *parser, BuildContext *bc) {
 	if (global_error_collector.count > 0) {
@@ -745,12 +1036,14 @@ void init_checker(Checker *c, Parser *parser, BuildContext *bc) {
 
 	c->parser = parser;
 	init_checker_info(&c->info);
+	init_checker_node_tables(&c->info, parser);
 
 	array_init(&c->proc_stack, a);
 	array_init(&c->procs, a);
 	array_init(&c->delayed_imports, a);
 	array_init(&c->delayed_foreign_libraries, a);
 	array_init(&c->file_nodes, a);
+	array_init(&c->workers, a);
 
 	for_array(i, parser->files) {
 		AstFile *file = &parser->files.e[i];
@@ -766,11 +1059,11 @@ void init_checker(Checker *c, Parser *parser, BuildContext *bc) {
 	isize total_token_count = 0;
 	for_array(i, c->parser->files) {
 		AstFile *f = &c->parser->files.e[i];
-		total_token_count += f->tokens.count;
+		total_token_count += f->token_count;
 	}
 	isize arena_size = 2 * item_size * total_token_count;
-	gb_arena_init_from_allocator(&c->arena, a, arena_size);
-	gb_arena_init_from_allocator(&c->tmp_arena, a, arena_size);
+	gb_arena_init_from_allocator(&c->arena, tagged_allocator(MemoryTag_Types), arena_size);
+	gb_arena_init_from_allocator(&c->tmp_arena, tagged_allocator(MemoryTag_Types), arena_size);
 
 
 	c->allocator     = gb_arena_allocator(&c->arena);
@@ -780,8 +1073,25 @@ void init_checker(Checker *c, Parser *parser, BuildContext *bc) {
 	c->context.scope = c->global_scope;
 }
 
+void destroy_checker_worker(Checker *w) {
+	destroy_checker_info(&w->info);
+	array_free(&w->proc_stack);
+	array_free(&w->procs);
+	array_free(&w->type_info_queue);
+	array_free(&w->unnumbered_entities);
+	array_free(&w->used_entities);
+
+	gb_vm_free(gb_virtual_memory(w->tmp_arena.physical_start, w->tmp_arena.total_size));
+	gb_free(heap_allocator(), w);
+}
+
 void destroy_checker(Checker *c) {
+	for_array(i, c->workers) {
+		destroy_checker_worker(c->workers.e[i]);
+	}
+	array_free(&c->workers);
 	destroy_checker_info(&c->info);
+	destroy_checker_node_tables(&c->info);
 	destroy_scope(c->global_scope);
 	array_free(&c->proc_stack);
 	array_free(&c->procs);
@@ -794,15 +1104,32 @@ void destroy_checker(Checker *c) {
 
 
 
+Entity *definition_of_ident(CheckerInfo *i, AstNode *identifier) {
+	isize id = ast_node_id(i, identifier);
+	return id >= 0 ? i->definitions[id] : NULL;
+}
+
+Entity *use_of_ident(CheckerInfo *i, AstNode *identifier) {
+	isize id = ast_node_id(i, identifier);
+	return id >= 0 ? i->uses[id] : NULL;
+}
+
+Scope *scope_of_node(CheckerInfo *i, AstNode *node) {
+	isize id = ast_node_id(i, node);
+	return id >= 0 ? i->scopes[id] : NULL;
+}
+
+Entity *implicit_entity_of_node(CheckerInfo *i, AstNode *node) {
+	isize id = ast_node_id(i, node);
+	return id >= 0 ? i->implicits[id] : NULL;
+}
+
 Entity *entity_of_ident(CheckerInfo *i, AstNode *identifier) {
 	if (identifier->kind == AstNode_Ident) {
-		Entity **found = map_entity_get(&i->definitions, hash_pointer(identifier));
-		if (found) {
-			return *found;
-		}
-		found = map_entity_get(&i->uses, hash_pointer(identifier));
-		if (found) {
-			return *found;
+		isize id = ast_node_id(i, identifier);
+		if (id >= 0) {
+			Entity *e = i->definitions[id];
+			return e != NULL ? e : i->uses[id];
 		}
 	}
 	return NULL;
@@ -811,8 +1138,8 @@ Entity *entity_of_ident(CheckerInfo *i, AstNode *identifier) {
 
 TypeAndValue type_and_value_of_expr(CheckerInfo *i, AstNode *expression) {
 	TypeAndValue result = {0};
-	TypeAndValue *found = map_tav_get(&i->types, hash_pointer(expression));
-	if (found) result = *found;
+	isize id = ast_node_id(i, expression);
+	if (id >= 0) result = i->types[id];
 	return result;
 }
 
@@ -857,11 +1184,13 @@ void add_type_and_value(CheckerInfo *i, AstNode *expression, AddressingMode mode
 		}
 	}
 
-	TypeAndValue tv = {0};
-	tv.type  = type;
-	tv.value = value;
-	tv.mode  = mode;
-	map_tav_set(&i->types, hash_pointer(expression), tv);
+	isize id = ast_node_id(i, expression);
+	if (id >= 0) {
+		TypeAndValue *tv = &i->types[id];
+		tv->type  = type;
+		tv->value = value;
+		tv->mode  = mode;
+	}
 }
 
 void add_entity_definition(CheckerInfo *i, AstNode *identifier, Entity *entity) {
@@ -870,8 +1199,10 @@ void add_entity_definition(CheckerInfo *i, AstNode *identifier, Entity *entity)
 		if (str_eq(identifier->Ident.string, str_lit("_"))) {
 			return;
 		}
-		HashKey key = hash_pointer(identifier);
-		map_entity_set(&i->definitions, key, entity);
+		isize id = ast_node_id(i, identifier);
+		if (id >= 0) {
+			i->definitions[id] = entity;
+		}
 	} else {
 		// NOTE(bill): Error should handled elsewhere
 	}
@@ -884,6 +1215,9 @@ bool add_entity(Checker *c, Scope *scope, AstNode *identifier, Entity *entity) {
 		if (ie) {
 			TokenPos pos = ie->token.pos;
 			Entity *up = ie->using_parent;
+			if (up == NULL) {
+				up = scope_using_parent(scope, ie);
+			}
 			if (up != NULL) {
 				if (token_pos_eq(pos, up->token.pos)) {
 					// NOTE(bill): Error should have been handled already
@@ -893,7 +1227,7 @@ bool add_entity(Checker *c, Scope *scope, AstNode *identifier, Entity *entity) {
 				      "Redeclaration of `%.*s` in this scope through `using`\n"
 				      "\tat %.*s(%td:%td)",
 				      LIT(name),
-				      LIT(up->token.pos.file), up->token.pos.line, up->token.pos.column);
+				      LIT(token_pos_file(up->token.pos)), token_pos_line(up->token.pos), token_pos_column(up->token.pos));
 				return false;
 			} else {
 				if (token_pos_eq(pos, entity->token.pos)) {
@@ -904,7 +1238,7 @@ bool add_entity(Checker *c, Scope *scope, AstNode *identifier, Entity *entity) {
 				      "Redeclaration of `%.*s` in this scope\n"
 				      "\tat %.*s(%td:%td)",
 				      LIT(name),
-				      LIT(pos.file), pos.line, pos.column);
+				      LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 				return false;
 			}
 		}
@@ -920,11 +1254,26 @@ void add_entity_use(Checker *c, AstNode *identifier, Entity *entity) {
 	if (identifier->kind != AstNode_Ident) {
 		return;
 	}
-	HashKey key = hash_pointer(identifier);
-	map_entity_set(&c->info.uses, key, entity);
+	isize id = ast_node_id(&c->info, identifier);
+	if (id >= 0) {
+		c->info.uses[id] = entity;
+	}
 	add_declaration_dependency(c, entity); // TODO(bill): Should this be here?
 }
 
+// NOTE: A worker only sets this on the entities it made itself, the others are shared with the
+// other workers and are set when its results are merged
+void set_entity_used(Checker *c, Entity *e) {
+	if (e->flags & EntityFlag_Used) {
+		return;
+	}
+	if (c->shared_info != NULL && e->id != 0) {
+		array_add(&c->used_entities, e);
+		return;
+	}
+	e->flags |= EntityFlag_Used;
+}
+
 
 void add_entity_and_decl_info(Checker *c, AstNode *identifier, Entity *e, DeclInfo *d) {
 	GB_ASSERT(identifier->kind == AstNode_Ident);
@@ -938,7 +1287,10 @@ void add_entity_and_decl_info(Checker *c, AstNode *identifier, Entity *e, DeclIn
 void add_implicit_entity(Checker *c, AstNode *node, Entity *e) {
 	GB_ASSERT(node != NULL);
 	GB_ASSERT(e != NULL);
-	map_entity_set(&c->info.implicits, hash_pointer(node), e);
+	isize id = ast_node_id(&c->info, node);
+	if (id >= 0) {
+		c->info.implicits[id] = e;
+	}
 }
 
 
@@ -946,6 +1298,14 @@ void add_type_info_type(Checker *c, Type *t) {
 	if (t == NULL) {
 		return;
 	}
+	if (c->type_info_capture != NULL) {
+		array_add(c->type_info_capture, t);
+	}
+	if (c->shared_info != NULL) {
+		// NOTE: Type info indices depend on the order types are added in
+		array_add(&c->type_info_queue, t);
+		return;
+	}
 	t = default_type(t);
 	if (is_type_untyped(t)) {
 		return; // Could be nil
@@ -1111,8 +1471,7 @@ Type *const curr_procedure_type(Checker *c) {
 
 void add_curr_ast_file(Checker *c, AstFile *file) {
 	if (file != NULL) {
-		TokenPos zero_pos = {0};
-		global_error_collector.prev = zero_pos;
+		error_reset_prev_pos();
 		c->curr_ast_file = file;
 		c->context.decl  = file->decl_info;
 		c->context.scope = file->scope;
@@ -1123,55 +1482,123 @@ void add_curr_ast_file(Checker *c, AstFile *file) {
 
 
 
-void add_dependency_to_map(MapEntity *map, CheckerInfo *info, Entity *node) {
-	if (node == NULL) {
-		return;
-	}
-	if (map_entity_get(map, hash_pointer(node)) != NULL) {
-		return;
+// NOTE: A set of entities with a bit per entity id, as ids are dense. Entities made after the set
+// have ids past its end and are not in it.
+typedef struct EntitySet {
+	u64 * bits;
+	isize count; // NOTE: In ids
+} EntitySet;
+
+EntitySet make_entity_set(gbAllocator a, isize count) {
+	EntitySet s = {0};
+	s.count = count;
+	s.bits  = gb_alloc_array(a, u64, (count+63)/64);
+	gb_zero_size(s.bits, gb_size_of(u64)*((count+63)/64));
+	return s;
+}
+
+gb_inline bool entity_set_has(EntitySet *s, Entity *e) {
+	isize id = cast(isize)e->id;
+	return id < s->count && (s->bits[id/64] & (1ull << (id%64))) != 0;
+}
+
+// NOTE: Returns false if `e` was already in the set
+gb_inline bool entity_set_add(EntitySet *s, Entity *e) {
+	isize id = cast(isize)e->id;
+	GB_ASSERT(id < s->count);
+	u64 bit = 1ull << (id%64);
+	if ((s->bits[id/64] & bit) != 0) {
+		return false;
 	}
-	map_entity_set(map, hash_pointer(node), node);
+	s->bits[id/64] |= bit;
+	return true;
+}
 
+int entity_id_cmp(void const *a, void const *b) {
+	u64 x = (*cast(Entity *const *)a)->id;
+	u64 y = (*cast(Entity *const *)b)->id;
+	return x < y ? -1 : x > y;
+}
 
-	DeclInfo **found = map_decl_info_get(&info->entities, hash_pointer(node));
-	if (found == NULL) {
+// NOTE: Sorts the dependencies by id and removes the repeats
+void compact_dependencies(DeclInfo *d) {
+	if (d->deps.count < 2) {
 		return;
 	}
+	gb_sort_array(d->deps.e, d->deps.count, entity_id_cmp);
+	isize count = 1;
+	for (isize i = 1; i < d->deps.count; i++) {
+		if (d->deps.e[i] != d->deps.e[count-1]) {
+			d->deps.e[count++] = d->deps.e[i];
+		}
+	}
+	d->deps.count = count;
+}
 
-	DeclInfo *decl = *found;
-	for_array(i, decl->deps.entries) {
-		Entity *e = cast(Entity *)decl->deps.entries.e[i].key.ptr;
-		add_dependency_to_map(map, info, e);
+void add_dependency_to_set(EntitySet *set, EntityArray *worklist, Entity *e) {
+	if (e != NULL && entity_set_add(set, e)) {
+		array_add(worklist, e);
 	}
 }
 
-MapEntity generate_minimum_dependency_map(CheckerInfo *info, Entity *start) {
-	MapEntity map = {0}; // Key: Entity *
-	map_entity_init(&map, heap_allocator());
+// NOTE: Everything reachable from `start`, the exported and foreign procedures and the
+// #shared_global_scope entities through the dependencies of their declarations
+EntitySet generate_minimum_dependency_set(CheckerInfo *info, Entity *start) {
+	gbAllocator a = heap_allocator();
+	isize count = cast(isize)global_entity_id + 1;
+
+	DeclInfo **decls = gb_alloc_array(a, DeclInfo *, count); // NOTE: By entity id
+	gb_zero_size(decls, gb_size_of(DeclInfo *)*count);
+	for_array(i, info->entities.entries) {
+		Entity *e = cast(Entity *)info->entities.entries.e[i].key.ptr;
+		DeclInfo *d = info->entities.entries.e[i].value;
+		compact_dependencies(d);
+		decls[e->id] = d;
+	}
+
+	EntitySet set = make_entity_set(a, count);
+	EntityArray worklist = {0};
+	array_init(&worklist, a);
 
-	for_array(i, info->definitions.entries) {
-		Entity *e = info->definitions.entries.e[i].value;
+	for (isize i = 0; i < info->node_count; i++) {
+		Entity *e = info->definitions[i];
+		if (e == NULL) {
+			continue;
+		}
 		if (e->scope->is_global) {
 			// NOTE(bill): Require runtime stuff
-			add_dependency_to_map(&map, info, e);
+			add_dependency_to_set(&set, &worklist, e);
 		} else if (e->kind == Entity_Procedure) {
 			if ((e->Procedure.tags & ProcTag_export) != 0) {
-				add_dependency_to_map(&map, info, e);
+				add_dependency_to_set(&set, &worklist, e);
 			}
 			if (e->Procedure.is_foreign) {
-				add_dependency_to_map(&map, info, e->Procedure.foreign_library);
+				add_dependency_to_set(&set, &worklist, e->Procedure.foreign_library);
 			}
 		}
 	}
 
-	add_dependency_to_map(&map, info, start);
+	add_dependency_to_set(&set, &worklist, start);
+
+	while (worklist.count > 0) {
+		Entity *e = worklist.e[--worklist.count];
+		DeclInfo *d = decls[e->id];
+		if (d == NULL) {
+			continue;
+		}
+		for_array(i, d->deps) {
+			add_dependency_to_set(&set, &worklist, d->deps.e[i]);
+		}
+	}
 
-	return map;
+	array_free(&worklist);
+	gb_free(a, decls);
+	return set;
 }
 
 
 Entity *find_core_entity(Checker *c, String name) {
-	Entity *e = current_scope_lookup_entity(c->global_scope, name);
+	Entity *e = current_scope_lookup_entity(c->global_scope, hash_string(name));
 	if (e == NULL) {
 		compiler_error("Could not find type declaration for `%.*s`\n"
 		               "Is `_preload.odin` missing from the `core` directory relative to odin.exe?", LIT(name));
@@ -1190,6 +1617,7 @@ void init_preload(Checker *c) {
 
 		t_type_info = type_info_entity->type;
 		t_type_info_ptr = make_type_pointer(c->allocator, t_type_info);
+		init_entities_of_any(c->allocator);
 		GB_ASSERT(is_type_union(type_info_entity->type));
 		TypeRecord *record = &base_type(type_info_entity->type)->Record;
 
@@ -1284,7 +1712,7 @@ bool check_is_entity_overloaded(Entity *e) {
 		return false;
 	}
 	Scope *s = e->scope;
-	HashKey key = hash_string(e->token.string);
+	HashKey key = hash_token(e->token);
 	isize overload_count = map_entity_multi_count(&s->elements, key);
 	return overload_count > 1;
 }
@@ -1302,8 +1730,7 @@ void check_procedure_overloading(Checker *c, Entity *e) {
 
 	// NOTE(bill): Procedures call only overload other procedures in the same scope
 
-	String name = e->token.string;
-	HashKey key = hash_string(name);
+	HashKey key = hash_token(e->token);
 	Scope *s = e->scope;
 	isize overload_count = map_entity_multi_count(&s->elements, key);
 	GB_ASSERT(overload_count >= 1);
@@ -1364,7 +1791,7 @@ void check_procedure_overloading(Checker *c, Entity *e) {
 			}
 
 			if (is_invalid) {
-				gb_printf_err("\tprevious procedure at %.*s(%td:%td)\n", LIT(pos.file), pos.line, pos.column);
+				error_line("\tprevious procedure at %.*s(%td:%td)\n", LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 				q->type = t_invalid;
 			}
 		}
@@ -1488,7 +1915,7 @@ void check_collect_entities(Checker *c, AstNodeArray nodes, bool is_file_scope)
 				Entity **entities = gb_alloc_array(c->allocator, Entity *, entity_cap);
 				DeclInfo *di = NULL;
 				if (vd->values.count > 0) {
-					di = make_declaration_info(heap_allocator(), c->context.scope, c->context.decl);
+					di = make_declaration_info(tagged_allocator(MemoryTag_CheckerMaps), c->context.scope, c->context.decl);
 					di->entities = entities;
 					di->type_expr = vd->type;
 					di->init_expr = vd->values.e[0];
@@ -1523,7 +1950,7 @@ void check_collect_entities(Checker *c, AstNodeArray nodes, bool is_file_scope)
 					DeclInfo *d = di;
 					if (d == NULL) {
 						AstNode *init_expr = value;
-						d = make_declaration_info(heap_allocator(), e->scope, c->context.decl);
+						d = make_declaration_info(tagged_allocator(MemoryTag_CheckerMaps), e->scope, c->context.decl);
 						d->type_expr = vd->type;
 						d->init_expr = init_expr;
 					}
@@ -1810,9 +2237,9 @@ void check_import_entities(Checker *c, MapScope *file_scopes) {
 		if (found == NULL) {
 			for_array(scope_index, file_scopes->entries) {
 				Scope *scope = file_scopes->entries.e[scope_index].value;
-				gb_printf_err("%.*s\n", LIT(scope->file->tokenizer.fullpath));
+				error_line("%.*s\n", LIT(scope->file->tokenizer.fullpath));
 			}
-			gb_printf_err("%.*s(%td:%td)\n", LIT(token.pos.file), token.pos.line, token.pos.column);
+			error_line("%.*s(%td:%td)\n", LIT(token_pos_file(token.pos)), token_pos_line(token.pos), token_pos_column(token.pos));
 			GB_PANIC("Unable to find scope for file: %.*s", LIT(id->fullpath));
 		}
 		Scope *scope = *found;
@@ -1883,9 +2310,9 @@ void check_import_entities(Checker *c, MapScope *file_scopes) {
 		if (found == NULL) {
 			for_array(scope_index, file_scopes->entries) {
 				Scope *scope = file_scopes->entries.e[scope_index].value;
-				gb_printf_err("%.*s\n", LIT(scope->file->tokenizer.fullpath));
+				error_line("%.*s\n", LIT(scope->file->tokenizer.fullpath));
 			}
-			gb_printf_err("%.*s(%td:%td)\n", LIT(token.pos.file), token.pos.line, token.pos.column);
+			error_line("%.*s(%td:%td)\n", LIT(token_pos_file(token.pos)), token_pos_line(token.pos), token_pos_column(token.pos));
 			GB_PANIC("Unable to find scope for file: %.*s", LIT(id->fullpath));
 		}
 		Scope *scope = *found;
@@ -1954,8 +2381,8 @@ void check_import_entities(Checker *c, MapScope *file_scopes) {
 			if (str_eq(import_name, str_lit("_"))) {
 				error(token, "File name, %.*s, cannot be as an import name as it is not a valid identifier", LIT(id->import_name.string));
 			} else {
-				GB_ASSERT(id->import_name.pos.line != 0);
-				id->import_name.string = import_name;
+				GB_ASSERT(id->import_name.pos.file_id != 0);
+				token_set_string(&id->import_name, import_name);
 				Entity *e = make_entity_import_name(c->allocator, parent_scope, id->import_name, t_invalid,
 				                                    id->fullpath, id->import_name.string,
 				                                    scope);
@@ -2006,8 +2433,8 @@ void check_import_entities(Checker *c, MapScope *file_scopes) {
 		if (str_eq(library_name, str_lit("_"))) {
 			error(fl->token, "File name, %.*s, cannot be as a library name as it is not a valid identifier", LIT(fl->library_name.string));
 		} else {
-			GB_ASSERT(fl->library_name.pos.line != 0);
-			fl->library_name.string = library_name;
+			GB_ASSERT(fl->library_name.pos.file_id != 0);
+			token_set_string(&fl->library_name, library_name);
 			Entity *e = make_entity_library_name(c->allocator, parent_scope, fl->library_name, t_invalid,
 			                                     file_str, library_name);
 			add_entity(c, parent_scope, NULL, e);
@@ -2016,6 +2443,262 @@ void check_import_entities(Checker *c, MapScope *file_scopes) {
 }
 
 
+void check_procedure_info(Checker *c, ProcedureInfo *pi) {
+	CheckerContext prev_context = c->context;
+	add_curr_ast_file(c, pi->file);
+
+	bool bounds_check    = (pi->tags & ProcTag_bounds_check)    != 0;
+	bool no_bounds_check = (pi->tags & ProcTag_no_bounds_check) != 0;
+
+
+	if (bounds_check) {
+		c->context.stmt_state_flags |= StmtStateFlag_bounds_check;
+		c->context.stmt_state_flags &= ~StmtStateFlag_no_bounds_check;
+	} else if (no_bounds_check) {
+		c->context.stmt_state_flags |= StmtStateFlag_no_bounds_check;
+		c->context.stmt_state_flags &= ~StmtStateFlag_bounds_check;
+	}
+
+	check_proc_body(c, pi->token, pi->decl, pi->type, pi->body);
+
+	c->context = prev_context;
+}
+
+GB_ALLOCATOR_PROC(checker_worker_arena_allocator_proc) {
+	CheckerWorkerArena *a = cast(CheckerWorkerArena *)allocator_data;
+	void *ptr = NULL;
+
+	switch (type) {
+	case gbAllocation_Alloc: {
+		isize total_size = size + alignment;
+		if (a->curr == NULL || total_size > a->end - a->curr) {
+			gbAllocator parent = gb_arena_allocator(a->parent);
+			isize block_size = CHECKER_WORKER_ARENA_BLOCK_SIZE;
+			if (total_size > block_size/4) {
+				// NOTE: Large allocations do not start a new block, which would waste the rest of this one
+				gb_mutex_lock(&checker_mutex);
+				ptr = gb_alloc_align(parent, size, alignment);
+				gb_mutex_unlock(&checker_mutex);
+				break;
+			}
+			gb_mutex_lock(&checker_mutex);
+			a->curr = cast(u8 *)gb_alloc(parent, block_size);
+			gb_mutex_unlock(&checker_mutex);
+			if (a->curr == NULL) {
+				a->end = NULL;
+				return NULL;
+			}
+			a->end = a->curr + block_size;
+		}
+		ptr = gb_align_forward(a->curr, alignment);
+		a->curr = cast(u8 *)ptr + size;
+		if (flags & gbAllocatorFlag_ClearToZero) {
+			gb_zero_size(ptr, size);
+		}
+	} break;
+
+	case gbAllocation_Free:
+		break;
+
+	case gbAllocation_FreeAll:
+		GB_PANIC("free_all is not supported by this allocator");
+		break;
+
+	case gbAllocation_Resize: {
+		gbAllocator allocator = {checker_worker_arena_allocator_proc, allocator_data};
+		ptr = gb_default_resize_align(allocator, old_memory, old_size, size, alignment);
+	} break;
+	}
+
+	return ptr;
+}
+
+Checker *make_checker_worker(Checker *c) {
+	gbAllocator a = heap_allocator();
+	Checker *w = gb_alloc_item(a, Checker);
+	*w = *c;
+	w->shared_info = &c->info;
+	init_checker_info(&w->info); // NOTE: The node tables are shared, as a node is only checked by one worker
+	array_init(&w->procs, a);
+	array_init(&w->proc_stack, a);
+	array_init(&w->type_info_queue, a);
+	array_init(&w->unnumbered_entities, a);
+	array_init(&w->used_entities, a);
+	array_init(&w->workers, a);
+
+	gb_zero_item(&w->arena);
+	w->worker_arena.parent = &c->arena;
+	w->worker_arena.curr   = NULL;
+	w->worker_arena.end    = NULL;
+	// NOTE: What is allocated from the temporary arena only lives until the end of the statement or
+	// type being checked, so the workers share out its size between them
+	isize tmp_size = c->tmp_arena.total_size / gb_max(build_context.thread_count, 1);
+	gbVirtualMemory vm = vm_alloc_or_exit(tmp_size);
+	gb_arena_init_from_memory(&w->tmp_arena, vm.data, vm.size);
+	w->allocator.proc = checker_worker_arena_allocator_proc;
+	w->allocator.data = &w->worker_arena;
+	w->tmp_allocator  = gb_arena_allocator(&w->tmp_arena);
+	return w;
+}
+
+CheckerProcMark checker_proc_mark(Checker *w) {
+	CheckerProcMark m = {0};
+	m.untyped             = w->info.untyped.entries.count;
+	m.entities            = w->info.entities.entries.count;
+	m.type_infos          = w->type_info_queue.count;
+	m.procs               = w->procs.count;
+	m.unnumbered_entities = w->unnumbered_entities.count;
+	m.used_entities       = w->used_entities.count;
+	return m;
+}
+
+// NOTE: Adds what a worker recorded for one procedure as if `c` had checked it itself
+void merge_checked_proc(Checker *c, CheckedProc *cp, DeclInfo *decl) {
+	Checker *w = cp->worker;
+	CheckerProcMark s = cp->start;
+	CheckerProcMark e = cp->end;
+
+	for (isize i = s.untyped; i < e.untyped; i++) {
+		map_expr_info_set(&c->info.untyped, w->info.untyped.entries.e[i].key, w->info.untyped.entries.e[i].value);
+	}
+	for (isize i = s.entities; i < e.entities; i++) {
+		map_decl_info_set(&c->info.entities, w->info.entities.entries.e[i].key, w->info.entities.entries.e[i].value);
+	}
+
+	for (isize i = s.type_infos; i < e.type_infos; i++) {
+		add_type_info_type(c, w->type_info_queue.e[i]);
+	}
+	for (isize i = s.unnumbered_entities; i < e.unnumbered_entities; i++) {
+		w->unnumbered_entities.e[i]->id = ++global_entity_id;
+	}
+	for (isize i = s.used_entities; i < e.used_entities; i++) {
+		w->used_entities.e[i]->flags |= EntityFlag_Used;
+	}
+	for (isize i = s.procs; i < e.procs; i++) {
+		array_add(&c->procs, w->procs.e[i]);
+	}
+	add_dependencies_to_parent(decl);
+}
+
+void clear_checker_worker(Checker *w) {
+	map_expr_info_clear(&w->info.untyped);
+	map_decl_info_clear(&w->info.entities);
+	array_clear(&w->type_info_queue);
+	array_clear(&w->procs);
+	array_clear(&w->unnumbered_entities);
+	array_clear(&w->used_entities);
+}
+
+// NOTE: Grows the maps once for what all the workers recorded rather than while merging
+void reserve_for_checker_workers(Checker *c, isize worker_count) {
+	CheckerProcMark total = checker_proc_mark(c);
+	for (isize i = 0; i < worker_count; i++) {
+		CheckerProcMark m = checker_proc_mark(c->workers.e[i]);
+		total.untyped  += m.untyped;
+		total.entities += m.entities;
+	}
+	map_expr_info_reserve(&c->info.untyped,  total.untyped);
+	map_decl_info_reserve(&c->info.entities, total.entities);
+}
+
+typedef struct CheckerWave {
+	ProcedureInfo *procs;
+	CheckedProc *  checked;
+	isize          count;
+	gbAtomic32     next;
+} CheckerWave;
+
+typedef struct CheckerWorkerData {
+	Checker *    worker;
+	CheckerWave *wave;
+} CheckerWorkerData;
+
+GB_THREAD_PROC(check_proc_bodies_worker_proc) {
+	CheckerWorkerData *wd = cast(CheckerWorkerData *)data;
+	Checker *w = wd->worker;
+	CheckerWave *wave = wd->wave;
+
+	unnumbered_entities = &w->unnumbered_entities;
+	for (;;) {
+		isize index = gb_atomic32_fetch_add(&wave->next, 1);
+		if (index >= wave->count) {
+			break;
+		}
+		CheckedProc *cp = &wave->checked[index];
+		cp->worker = w;
+		cp->start = checker_proc_mark(w);
+		check_procedure_info(w, &wave->procs[index]);
+		cp->end = checker_proc_mark(w);
+	}
+	unnumbered_entities = NULL;
+}
+
+// NOTE(bill): Nested procedures bodies will be added to this "queue"
+// NOTE: With more than one thread, the bodies queued so far are checked in parallel as a "wave",
+// each worker recording into its own CheckerInfo. The results are then merged in queue order,
+// which puts the nested procedures found in that wave at the end of the queue as checking the
+// bodies one after another would have, and the next wave checks those.
+// Errors are sorted by position in either case so the output does not depend on the thread count.
+void check_proc_bodies(Checker *c) {
+	begin_error_buffering();
+
+	isize thread_count = build_context.thread_count;
+	if (thread_count <= 1) {
+		for_array(i, c->procs) {
+			check_procedure_info(c, &c->procs.e[i]);
+		}
+		end_error_buffering();
+		return;
+	}
+
+	while (c->workers.count < thread_count) {
+		array_add(&c->workers, make_checker_worker(c));
+	}
+	gbThread *threads = gb_alloc_array(heap_allocator(), gbThread, thread_count);
+	CheckerWorkerData *worker_data = gb_alloc_array(heap_allocator(), CheckerWorkerData, thread_count);
+	Array(CheckedProc) checked = {0};
+	array_init(&checked, heap_allocator());
+
+	isize wave_start = 0;
+	while (wave_start < c->procs.count) {
+		CheckerWave wave = {0};
+		wave.count = c->procs.count - wave_start;
+		array_resize(&checked, wave.count);
+		wave.procs   = c->procs.e + wave_start;
+		wave.checked = checked.e;
+		gb_atomic32_store(&wave.next, 0);
+
+		isize worker_count = gb_min(thread_count, wave.count);
+		for (isize i = 0; i < worker_count; i++) {
+			worker_data[i].worker = c->workers.e[i];
+			worker_data[i].wave   = &wave;
+			gb_thread_init(&threads[i]);
+			gb_thread_start(&threads[i], check_proc_bodies_worker_proc, &worker_data[i]);
+		}
+		for (isize i = 0; i < worker_count; i++) {
+			gb_thread_join(&threads[i]);
+			gb_thread_destory(&threads[i]);
+		}
+
+		reserve_for_checker_workers(c, worker_count);
+		// NOTE: `c->procs` grows while merging
+		for (isize i = 0; i < wave.count; i++) {
+			DeclInfo *decl = c->procs.e[wave_start+i].decl;
+			merge_checked_proc(c, &checked.e[i], decl);
+		}
+		for (isize i = 0; i < worker_count; i++) {
+			clear_checker_worker(c->workers.e[i]);
+		}
+		wave_start += wave.count;
+	}
+
+	array_free(&checked);
+	gb_free(heap_allocator(), worker_data);
+	gb_free(heap_allocator(), threads);
+
+	end_error_buffering();
+}
+
 void check_parsed_files(Checker *c) {
 	MapScope file_scopes; // Key: String (fullpath)
 	map_scope_init(&file_scopes, heap_allocator());
@@ -2058,32 +2741,14 @@ void check_parsed_files(Checker *c) {
 
 	check_import_entities(c, &file_scopes);
 
+	for_array(i, file_scopes.entries) {
+		build_scope_lookup_table(file_scopes.entries.e[i].value);
+	}
+
 	check_all_global_entities(c);
 	init_preload(c); // NOTE(bill): This could be setup previously through the use of `type_info(_of_val)`
 
-	// Check procedure bodies
-	// NOTE(bill): Nested procedures bodies will be added to this "queue"
-	for_array(i, c->procs) {
-		ProcedureInfo *pi = &c->procs.e[i];
-		CheckerContext prev_context = c->context;
-		add_curr_ast_file(c, pi->file);
-
-		bool bounds_check    = (pi->tags & ProcTag_bounds_check)    != 0;
-		bool no_bounds_check = (pi->tags & ProcTag_no_bounds_check) != 0;
-
-
-		if (bounds_check) {
-			c->context.stmt_state_flags |= StmtStateFlag_bounds_check;
-			c->context.stmt_state_flags &= ~StmtStateFlag_no_bounds_check;
-		} else if (no_bounds_check) {
-			c->context.stmt_state_flags |= StmtStateFlag_no_bounds_check;
-			c->context.stmt_state_flags &= ~StmtStateFlag_bounds_check;
-		}
-
-		check_proc_body(c, pi->token, pi->decl, pi->type, pi->body);
-
-		c->context = prev_context;
-	}
+	check_proc_bodies(c);
 
 	// Add untyped expression values
 	for_array(i, c->info.untyped.entries) {
@@ -2122,9 +2787,9 @@ void check_parsed_files(Checker *c) {
 
 
 	// NOTE(bill): Check for illegal cyclic type declarations
-	for_array(i, c->info.definitions.entries) {
-		Entity *e = c->info.definitions.entries.e[i].value;
-		if (e->kind == Entity_TypeName) {
+	for (isize i = 0; i < c->info.node_count; i++) {
+		Entity *e = c->info.definitions[i];
+		if (e != NULL && e->kind == Entity_TypeName) {
 			if (e->type != NULL) {
 				// i64 size  = type_size_of(c->sizes, c->allocator, e->type);
 				i64 align = type_align_of(c->allocator, e->type);
@@ -2141,15 +2806,14 @@ void check_parsed_files(Checker *c) {
 		for_array(i, file_scopes.entries) {
 			Scope *s = file_scopes.entries.e[i].value;
 			if (s->is_init) {
-				Entity *e = current_scope_lookup_entity(s, str_lit("main"));
+				Entity *e = current_scope_lookup_entity(s, hash_string(str_lit("main")));
 				if (e == NULL) {
 					Token token = {0};
-					if (s->file->tokens.count > 0) {
-						token = s->file->tokens.e[0];
+					if (s->file->token_count > 0) {
+						token = s->file->first_token;
 					} else {
-						token.pos.file = s->file->tokenizer.fullpath;
-						token.pos.line = 1;
-						token.pos.column = 1;
+						token.pos.file_id = s->file->tokenizer.file_id;
+						token.pos.offset  = 0;
 					}
 
 					error(token, "Undefined entry point procedure `main`");
@@ -9,8 +9,153 @@
 
 #include <math.h>
 
+// NOTE: With -show-memory, heap allocations go through a tracking allocator that counts the live
+// bytes, the peak and the number of allocations of each subsystem (see `tagged_allocator`).
+// Memory that is mapped directly, e.g. source files and the IR print buffer, is counted with
+// `memory_tag_add`. Heap backed arenas count as the size of their blocks, not as what is used of
+// them, while the AST arenas only reserve address space and count as what the nodes use.
+typedef enum MemoryTag {
+	MemoryTag_Other,
+	MemoryTag_Tokenizer,   // Source files, tokens, unquoted strings
+	MemoryTag_Ast,         // The arenas and arrays of each AstFile
+	MemoryTag_CheckerMaps, // CheckerInfo and DeclInfo
+	MemoryTag_Scopes,      // The maps and arrays of each Scope
+	MemoryTag_Types,       // The checker's arenas, which hold the types, entities and scopes
+	MemoryTag_Ir,
+	MemoryTag_IrPrint,
+
+	MemoryTag_Count,
+} MemoryTag;
+
+gb_global char *const memory_tag_names[MemoryTag_Count] = {
+	"other",
+	"tokenizer",
+	"ast",
+	"checker maps",
+	"scopes",
+	"types",
+	"ir",
+	"ir print",
+};
+
+typedef struct MemoryTagStats {
+	gbAtomic64 live_bytes;
+	gbAtomic64 peak_bytes;
+	gbAtomic64 allocation_count;
+} MemoryTagStats;
+
+// NOTE: Set once at startup, before anything is allocated, as memory from one allocator cannot be
+// freed by the other
+gb_global bool           memory_tracking = false;
+gb_global MemoryTagStats memory_tag_stats[MemoryTag_Count] = {0};
+gb_global MemoryTagStats memory_total_stats = {0};
+
+void memory__stats_add(MemoryTagStats *s, i64 delta) {
+	i64 live = gb_atomic64_fetch_add(&s->live_bytes, delta) + delta;
+	if (delta > 0) {
+		gb_atomic64_fetch_add(&s->allocation_count, 1);
+	}
+	for (;;) {
+		i64 peak = gb_atomic64_load(&s->peak_bytes);
+		if (live <= peak || gb_atomic64_compare_exchange(&s->peak_bytes, peak, live) == peak) {
+			break;
+		}
+	}
+}
+
+void memory_tag_add(MemoryTag tag, i64 delta) {
+	if (memory_tracking) {
+		memory__stats_add(&memory_tag_stats[tag], delta);
+		memory__stats_add(&memory_total_stats, delta);
+	}
+}
+
+// NOTE: Stored just before each tracked allocation
+typedef struct MemoryHeader {
+	isize size;
+	i32   tag;
+	i32   offset; // NOTE: From the start of the underlying allocation to the user's memory
+} MemoryHeader;
+
+GB_ALLOCATOR_PROC(tracking_allocator_proc) {
+	gbAllocator heap = gb_heap_allocator();
+	MemoryTag tag = cast(MemoryTag)cast(intptr)allocator_data;
+
+	switch (type) {
+	case gbAllocation_Alloc: {
+		isize offset = gb_max(alignment, gb_size_of(MemoryHeader));
+		offset = (offset + alignment-1) & ~(alignment-1);
+		u8 *base = cast(u8 *)gb_alloc_align(heap, size+offset, alignment);
+		if (base == NULL) {
+			return NULL;
+		}
+		MemoryHeader *header = cast(MemoryHeader *)(base+offset) - 1;
+		header->size   = size;
+		header->tag    = cast(i32)tag;
+		header->offset = cast(i32)offset;
+		memory_tag_add(tag, size);
+		return base+offset;
+	}
+
+	case gbAllocation_Free: {
+		if (old_memory == NULL) {
+			return NULL;
+		}
+		MemoryHeader *header = cast(MemoryHeader *)old_memory - 1;
+		memory_tag_add(cast(MemoryTag)header->tag, -header->size);
+		gb_free(heap, cast(u8 *)old_memory - header->offset);
+		return NULL;
+	}
+
+	case gbAllocation_Resize: {
+		gbAllocator self = {tracking_allocator_proc, allocator_data};
+		void *new_memory = NULL;
+		if (size > 0) {
+			new_memory = gb_alloc_align(self, size, alignment);
+			if (new_memory != NULL && old_memory != NULL) {
+				gb_memmove(new_memory, old_memory, gb_min(size, old_size));
+			}
+		}
+		gb_free(self, old_memory);
+		return new_memory;
+	}
+
+	case gbAllocation_FreeAll:
+		break;
+	}
+	return NULL;
+}
+
+// NOTE: Memory from a tagged allocator may be freed with any other tagged allocator
+gbAllocator tagged_allocator(MemoryTag tag) {
+	if (!memory_tracking) {
+		return gb_heap_allocator();
+	}
+	gbAllocator a = {tracking_allocator_proc, cast(void *)cast(intptr)tag};
+	return a;
+}
+
 gbAllocator heap_allocator(void) {
-	return gb_heap_allocator();
+	return tagged_allocator(MemoryTag_Other);
+}
+
+void print_memory_report(void) {
+	if (!memory_tracking) {
+		gb_printf_err("Memory is only tracked when -show-memory is given directly to the compiler\n");
+		return;
+	}
+	gb_printf("Memory (live now, peak, allocations):\n");
+	for (isize i = 0; i < MemoryTag_Count; i++) {
+		MemoryTagStats *s = &memory_tag_stats[i];
+		gb_printf("    %s: %.2f MiB, %.2f MiB, %lld\n", memory_tag_names[i],
+		          cast(f64)gb_atomic64_load(&s->live_bytes)/gb_megabytes(1),
+		          cast(f64)gb_atomic64_load(&s->peak_bytes)/gb_megabytes(1),
+		          cast(long long)gb_atomic64_load(&s->allocation_count));
+	}
+	gb_printf("    total: %.2f MiB, %.2f MiB, %lld\n",
+	          cast(f64)gb_atomic64_load(&memory_total_stats.live_bytes)/gb_megabytes(1),
+	          cast(f64)gb_atomic64_load(&memory_total_stats.peak_bytes)/gb_megabytes(1),
+	          cast(long long)gb_atomic64_load(&memory_total_stats.allocation_count));
 }
 
 #include "unicode.c"
@@ -32,6 +177,40 @@ gbAllocator scratch_allocator(void) {
 	return gb_scratch_allocator(&scratch_memory);
 }
 
+// NOTE: For a value that one thread sets and others read without a lock. What the storing thread
+// wrote before the store is seen by a thread that loads the stored value.
+gb_inline i64 atomic_load_acquire_i64(i64 volatile *p) {
+#if defined(GB_COMPILER_MSVC)
+	return gb_atomic64_compare_exchange(cast(gbAtomic64 volatile *)p, 0, 0);
+#else
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+gb_inline void atomic_store_release_i64(i64 volatile *p, i64 value) {
+#if defined(GB_COMPILER_MSVC)
+	gb_atomic64_exchanged(cast(gbAtomic64 volatile *)p, value);
+#else
+	__atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+}
+
+// NOTE: On POSIX the pages are only committed once they are touched, gb_vm_alloc on Windows
+// commits all of them up front. Quits if the memory cannot be mapped.
+gbVirtualMemory vm_alloc_or_exit(isize size) {
+	gbVirtualMemory vm = gb_vm_alloc(NULL, size);
+#if defined(GB_SYSTEM_WINDOWS)
+	bool failed = vm.data == NULL;
+#else
+	bool failed = vm.data == MAP_FAILED;
+#endif
+	if (failed) {
+		gb_printf_err("Unable to map %td bytes of memory\n", size);
+		gb_exit(1);
+	}
+	return vm;
+}
+
 typedef struct DynamicArenaBlock DynamicArenaBlock;
 typedef struct DynamicArena      DynamicArena;
 
@@ -233,6 +412,7 @@ f64 gb_sqrt(f64 x) {
 
 typedef Array(i32)   Array_i32;
 typedef Array(isize) Array_isize;
+typedef Array(String) StringArray;
 
 
 #define MAP_TYPE String
@@ -249,3 +429,5 @@ typedef Array(isize) Array_isize;
 #define MAP_PROC map_isize_
 #define MAP_NAME MapIsize
 #include "map.c"
+
+#include "atom.c"
@@ -150,7 +150,13 @@ bool is_entity_exported(Entity *e) {
 	return name.text[0] != '_';
 }
 
+typedef Array(Entity *) EntityArray;
+
 gb_global u64 global_entity_id = 0;
+// NOTE: Set on the threads that check procedure bodies. Their entities are numbered when the
+// results are merged, in procedure order, so that ids (and thus mangled names) do not depend on
+// the thread count
+gb_global gb_thread_local EntityArray *unnumbered_entities = NULL;
 
 Entity *alloc_entity(gbAllocator a, EntityKind kind, Scope *scope, Token token, Type *type) {
 	Entity *entity = gb_alloc_item(a, Entity);
@@ -158,7 +164,11 @@ Entity *alloc_entity(gbAllocator a, EntityKind kind, Scope *scope, Token token,
 	entity->scope  = scope;
 	entity->token  = token;
 	entity->type   = type;
-	entity->id     = ++global_entity_id;
+	if (unnumbered_entities != NULL) {
+		array_add(unnumbered_entities, entity);
+	} else {
+		entity->id = ++global_entity_id;
+	}
 	return entity;
 }
 
@@ -275,7 +285,7 @@ Entity *make_entity_label(gbAllocator a, Scope *scope, Token token, Type *type,
 
 
 Entity *make_entity_dummy_variable(gbAllocator a, Scope *scope, Token token) {
-	token.string = str_lit("_");
+	token_set_string(&token, str_lit("_"));
 	return make_entity_variable(a, scope, token, NULL, false);
 }
 
@@ -0,0 +1,333 @@
+// NOTE: Runs the external tools (opt, llc, the linker) without going through a shell. Arguments
+// are passed as an argv array so paths never need quoting. Several jobs may run at once, up to
+// `ExecJobs.max_running`; the stderr of each job is captured and printed in one piece when it
+// finishes so the output of concurrent jobs does not interleave. The stdin and stdout of a job may
+// be connected to pipes so that tools can be chained without temporary files.
+
+#if defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+#include <spawn.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <signal.h>
+
+extern char **environ;
+
+typedef Array(char *) ExecArgs;
+
+void exec_args_init(ExecArgs *args) {
+	array_init(args, heap_allocator());
+}
+
+void exec_args_destroy(ExecArgs *args) {
+	for_array(i, *args) {
+		gb_free(heap_allocator(), args->e[i]);
+	}
+	array_free(args);
+}
+
+void exec_arg(ExecArgs *args, char *fmt, ...) {
+	va_list va;
+	va_start(va, fmt);
+	char *buf = gb_bprintf_va(fmt, va);
+	va_end(va);
+
+	isize len = gb_strlen(buf);
+	char *arg = gb_alloc_array(heap_allocator(), char, len+1);
+	gb_memmove(arg, buf, len+1);
+	array_add(args, arg);
+}
+
+// NOTE: For user supplied flags such as `llc_flags`, which may hold several arguments
+void exec_args_split(ExecArgs *args, String flags) {
+	isize i = 0;
+	while (i < flags.len) {
+		while (i < flags.len && gb_char_is_space(flags.text[i])) {
+			i++;
+		}
+		isize start = i;
+		while (i < flags.len && !gb_char_is_space(flags.text[i])) {
+			i++;
+		}
+		if (i > start) {
+			exec_arg(args, "%.*s", cast(int)(i-start), flags.text+start);
+		}
+	}
+}
+
+typedef struct ExecJob {
+	char *   name;
+	bool     is_silent;      // NOTE: Only print the captured stderr if the job fails
+	pid_t    pid;
+	int      stderr_fd;      // NOTE: -1 once closed
+	gbString stderr_output;
+	i32      exit_code;
+} ExecJob;
+
+typedef struct ExecJobs {
+	isize          max_running;
+	Array(ExecJob) running;
+	i32            exit_code; // NOTE: Exit code of the first job that failed
+} ExecJobs;
+
+#define EXEC_JOBS_MAX 64
+
+void exec_jobs_init(ExecJobs *jobs, isize max_running) {
+	jobs->max_running = gb_clamp(max_running, 1, EXEC_JOBS_MAX);
+	jobs->exit_code = 0;
+	array_init(&jobs->running, heap_allocator());
+}
+
+void exec_jobs_destroy(ExecJobs *jobs) {
+	array_free(&jobs->running);
+}
+
+// NOTE: NULL terminated copy of the argument pointers, freed by the caller
+char **exec__argv(ExecArgs args) {
+	char **argv = gb_alloc_array(heap_allocator(), char *, args.count+1);
+	gb_memmove(argv, args.e, gb_size_of(char *)*args.count);
+	argv[args.count] = NULL;
+	return argv;
+}
+
+void exec__print_command(ExecArgs args) {
+	gb_printf_err("Failed to execute command:\n\t");
+	for_array(i, args) {
+		gb_printf_err("%s ", args.e[i]);
+	}
+	gb_printf_err("\n");
+}
+
+i32 exec__wait_pid(pid_t pid) {
+	int status = 0;
+	while (waitpid(pid, &status, 0) < 0) {
+		if (errno != EINTR) {
+			return -1;
+		}
+	}
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+void exec__finish_job(ExecJobs *jobs, ExecJob *job) {
+	job->exit_code = exec__wait_pid(job->pid);
+
+	isize len = gb_string_length(job->stderr_output);
+	if (len > 0 && (!job->is_silent || job->exit_code != 0)) {
+		gb_file_write(gb_file_get_standard(gbFileStandard_Error), job->stderr_output, len);
+	}
+	gb_string_free(job->stderr_output);
+
+	if (job->exit_code != 0 && jobs->exit_code == 0) {
+		jobs->exit_code = job->exit_code;
+	}
+}
+
+// NOTE: Reads the stderr of the running jobs until one of them closes it, then reaps that job
+void exec__wait_any(ExecJobs *jobs) {
+	GB_ASSERT(jobs->running.count > 0);
+	struct pollfd fds[EXEC_JOBS_MAX];
+	isize fd_count = jobs->running.count;
+
+	for (;;) {
+		for (isize i = 0; i < fd_count; i++) {
+			fds[i].fd      = jobs->running.e[i].stderr_fd;
+			fds[i].events  = POLLIN;
+			fds[i].revents = 0;
+		}
+		if (poll(fds, fd_count, -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			GB_PANIC("poll failed while waiting on child processes");
+		}
+
+		for (isize i = 0; i < fd_count; i++) {
+			if (fds[i].revents == 0) {
+				continue;
+			}
+			ExecJob *job = &jobs->running.e[i];
+			char buf[4096];
+			ssize_t n = read(job->stderr_fd, buf, gb_size_of(buf));
+			if (n > 0) {
+				job->stderr_output = gb_string_append_length(job->stderr_output, buf, n);
+				continue;
+			}
+			if (n < 0 && errno == EINTR) {
+				continue;
+			}
+
+			close(job->stderr_fd);
+			job->stderr_fd = -1;
+			exec__finish_job(jobs, job);
+			jobs->running.e[i] = jobs->running.e[jobs->running.count-1];
+			jobs->running.count--;
+			return;
+		}
+	}
+}
+
+// NOTE: Waits for a free slot if `max_running` jobs are already running. `stdin_fd` and `stdout_fd`
+// replace the standard streams of the child if they are not -1, and are closed here either way.
+// Returns false if the process could not be started.
+bool exec_jobs_start_with(ExecJobs *jobs, char *name, bool is_silent, ExecArgs args, int stdin_fd, int stdout_fd) {
+	while (jobs->running.count >= jobs->max_running) {
+		exec__wait_any(jobs);
+	}
+
+	int pipe_fds[2];
+	if (pipe(pipe_fds) != 0) {
+		if (stdin_fd  >= 0) close(stdin_fd);
+		if (stdout_fd >= 0) close(stdout_fd);
+		exec__print_command(args);
+		return false;
+	}
+	// NOTE: Keep the pipes of other jobs out of the children, dup2 clears this for stderr
+	fcntl(pipe_fds[0], F_SETFD, FD_CLOEXEC);
+	fcntl(pipe_fds[1], F_SETFD, FD_CLOEXEC);
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_addclose(&actions, pipe_fds[0]);
+	posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], 2);
+	posix_spawn_file_actions_addclose(&actions, pipe_fds[1]);
+	if (stdin_fd >= 0) {
+		posix_spawn_file_actions_adddup2(&actions, stdin_fd, 0);
+	}
+	if (stdout_fd >= 0) {
+		posix_spawn_file_actions_adddup2(&actions, stdout_fd, 1);
+	}
+
+	// NOTE: SIGPIPE is ignored by the compiler while it writes to pipes, see `exec_pipe`
+	posix_spawnattr_t attr;
+	sigset_t default_signals;
+	posix_spawnattr_init(&attr);
+	sigemptyset(&default_signals);
+	sigaddset(&default_signals, SIGPIPE);
+	posix_spawnattr_setsigdefault(&attr, &default_signals);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+
+	char **argv = exec__argv(args);
+	pid_t pid = 0;
+	int err = posix_spawnp(&pid, argv[0], &actions, &attr, argv, environ);
+	posix_spawnattr_destroy(&attr);
+	posix_spawn_file_actions_destroy(&actions);
+	gb_free(heap_allocator(), argv);
+	close(pipe_fds[1]);
+	if (stdin_fd  >= 0) close(stdin_fd);
+	if (stdout_fd >= 0) close(stdout_fd);
+
+	if (err != 0) {
+		close(pipe_fds[0]);
+		exec__print_command(args);
+		if (jobs->exit_code == 0) {
+			jobs->exit_code = -1;
+		}
+		return false;
+	}
+
+	ExecJob job = {0};
+	job.name          = name;
+	job.is_silent     = is_silent;
+	job.pid           = pid;
+	job.stderr_fd     = pipe_fds[0];
+	job.stderr_output = gb_string_make(heap_allocator(), "");
+	array_add(&jobs->running, job);
+	return true;
+}
+
+bool exec_jobs_start(ExecJobs *jobs, char *name, bool is_silent, ExecArgs args) {
+	return exec_jobs_start_with(jobs, name, is_silent, args, -1, -1);
+}
+
+// NOTE: Returns the exit code of the first job that failed, or 0
+i32 exec_jobs_wait_all(ExecJobs *jobs) {
+	while (jobs->running.count > 0) {
+		exec__wait_any(jobs);
+	}
+	return jobs->exit_code;
+}
+
+// NOTE: Neither end is inherited by child processes unless passed to `exec_jobs_start_with`
+bool exec_pipe(int fds[2]) {
+	// NOTE: A child that exits early must make writes to it fail rather than kill the compiler
+	signal(SIGPIPE, SIG_IGN);
+	if (pipe(fds) != 0) {
+		return false;
+	}
+	fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+	fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+	return true;
+}
+
+gb_internal GB_FILE_READ_AT_PROC(exec__pipe_read) {
+	ssize_t n = read(fd.i, buffer, size);
+	if (n < 0) {
+		return false;
+	}
+	if (bytes_read) *bytes_read = n;
+	return true;
+}
+
+// NOTE: Pipes cannot seek, so the offset is ignored and short writes are continued
+gb_internal GB_FILE_WRITE_AT_PROC(exec__pipe_write) {
+	u8 const *data = cast(u8 const *)buffer;
+	isize written = 0;
+	while (written < size) {
+		ssize_t n = write(fd.i, data+written, size-written);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		written += n;
+	}
+	if (bytes_written) *bytes_written = written;
+	return true;
+}
+
+gb_internal GB_FILE_SEEK_PROC(exec__pipe_seek) {
+	return false;
+}
+
+gb_internal GB_FILE_CLOSE_PROC(exec__pipe_close) {
+	close(fd.i);
+}
+
+gbFileOperations const exec_pipe_file_operations = {
+	exec__pipe_read,
+	exec__pipe_write,
+	exec__pipe_seek,
+	exec__pipe_close,
+};
+
+// NOTE: Lets one end of a pipe be used as a gbFile, e.g. by `irFileBuffer`
+void exec_pipe_file(gbFile *f, int fd) {
+	gbFileDescriptor desc = {0};
+	desc.i = fd;
+	gb_file_new(f, desc, exec_pipe_file_operations, "<pipe>");
+}
+
+// NOTE: Runs a single process to completion
+i32 exec_process(char *name, bool is_silent, ExecArgs args) {
+	ExecJobs jobs = {0};
+	exec_jobs_init(&jobs, 1);
+	exec_jobs_start(&jobs, name, is_silent, args);
+	i32 exit_code = exec_jobs_wait_all(&jobs);
+	exec_jobs_destroy(&jobs);
+	return exit_code;
+}
+
+// NOTE: Runs a process with the standard streams inherited, e.g. the program built by `odin run`
+i32 exec_process_inherit(ExecArgs args) {
+	char **argv = exec__argv(args);
+	pid_t pid = 0;
+	int err = posix_spawnp(&pid, argv[0], NULL, NULL, argv, environ);
+	gb_free(heap_allocator(), argv);
+	if (err != 0) {
+		exec__print_command(args);
+		return -1;
+	}
+	return exec__wait_pid(pid);
+}
+#endif
@@ -927,12 +927,15 @@ GB_DEF void gb_semaphore_wait   (gbSemaphore *s);
 
 
 // Mutex
-// TODO(bill): Should this be replaced with a CRITICAL_SECTION on win32 or is the better?
+// NOTE: Recursive mutex backed by the native primitives. The previous semaphore+owner "benaphore"
+// could let two threads in at once if the owner had not been published yet.
 typedef struct gbMutex {
-	gbSemaphore semaphore;
-	gbAtomic32  counter;
-	gbAtomic32  owner;
-	i32         recursion;
+#if defined(GB_SYSTEM_WINDOWS)
+	CRITICAL_SECTION    win32_critical_section;
+#else
+	pthread_mutex_t     pthread_mutex;
+	pthread_mutexattr_t pthread_mutexattr;
+#endif
 } gbMutex;
 
 GB_DEF void gb_mutex_init    (gbMutex *m);
@@ -3663,7 +3666,10 @@ gb_inline void *gb_memcopy(void *dest, void const *source, isize n) {
 		return NULL;
 	}
 
-	__asm__ __volatile__("rep movsb" : "+D"(dest), "+S"(source), "+c"(n) : : "memory");
+	// NOTE: `rep movsb` advances its operands, so `dest` must not be one of them or the end of the
+	// copy would be returned
+	void *d = dest;
+	__asm__ __volatile__("rep movsb" : "+D"(d), "+S"(source), "+c"(n) : : "memory");
 #else
 	u8 *d = cast(u8 *)dest;
 	u8 const *s = cast(u8 const *)source;
@@ -4590,59 +4596,47 @@ gb_inline void gb_semaphore_release(gbSemaphore *s) { gb_semaphore_post(s, 1); }
 #error
 #endif
 
-// NOTE(bill): THIS IS FUCKING AWESOME THAT THIS "MUTEX" IS FAST AND RECURSIVE TOO!
-// NOTE(bill): WHO THE FUCK NEEDS A NORMAL MUTEX NOW?!?!?!?!
 gb_inline void gb_mutex_init(gbMutex *m) {
-	gb_atomic32_store(&m->counter, 0);
-	gb_atomic32_store(&m->owner, gb_thread_current_id());
-	gb_semaphore_init(&m->semaphore);
-	m->recursion = 0;
+#if defined(GB_SYSTEM_WINDOWS)
+	InitializeCriticalSection(&m->win32_critical_section);
+#else
+	pthread_mutexattr_init(&m->pthread_mutexattr);
+	pthread_mutexattr_settype(&m->pthread_mutexattr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&m->pthread_mutex, &m->pthread_mutexattr);
+#endif
 }
 
-gb_inline void gb_mutex_destroy(gbMutex *m) { gb_semaphore_destroy(&m->semaphore); }
+gb_inline void gb_mutex_destroy(gbMutex *m) {
+#if defined(GB_SYSTEM_WINDOWS)
+	DeleteCriticalSection(&m->win32_critical_section);
+#else
+	pthread_mutex_destroy(&m->pthread_mutex);
+	pthread_mutexattr_destroy(&m->pthread_mutexattr);
+#endif
+}
 
 gb_inline void gb_mutex_lock(gbMutex *m) {
-	i32 thread_id = cast(i32)gb_thread_current_id();
-	if (gb_atomic32_fetch_add(&m->counter, 1) > 0) {
-		if (thread_id != gb_atomic32_load(&m->owner))
-			gb_semaphore_wait(&m->semaphore);
-	}
-
-	gb_atomic32_store(&m->owner, thread_id);
-	m->recursion++;
+#if defined(GB_SYSTEM_WINDOWS)
+	EnterCriticalSection(&m->win32_critical_section);
+#else
+	pthread_mutex_lock(&m->pthread_mutex);
+#endif
 }
 
 gb_inline b32 gb_mutex_try_lock(gbMutex *m) {
-	i32 thread_id = cast(i32)gb_thread_current_id();
-	if (gb_atomic32_load(&m->owner) == thread_id) {
-		gb_atomic32_fetch_add(&m->counter, 1);
-	} else {
-		i32 expected = 0;
-		if (gb_atomic32_load(&m->counter) != 0)
-			return false;
-		if (!gb_atomic32_compare_exchange(&m->counter, expected, 1))
-			return false;
-		gb_atomic32_store(&m->owner, thread_id);
-	}
-
-	m->recursion++;
-	return true;
+#if defined(GB_SYSTEM_WINDOWS)
+	return TryEnterCriticalSection(&m->win32_critical_section) != 0;
+#else
+	return pthread_mutex_trylock(&m->pthread_mutex) == 0;
+#endif
 }
 
 gb_inline void gb_mutex_unlock(gbMutex *m) {
-	i32 recursion;
-	i32 thread_id = cast(i32)gb_thread_current_id();
-
-	GB_ASSERT(thread_id == gb_atomic32_load(&m->owner));
-
-	recursion = --m->recursion;
-	if (recursion == 0)
-		gb_atomic32_store(&m->owner, thread_id);
-
-	if (gb_atomic32_fetch_add(&m->counter, -1) > 1) {
-		if (recursion == 0)
-			gb_semaphore_release(&m->semaphore);
-	}
+#if defined(GB_SYSTEM_WINDOWS)
+	LeaveCriticalSection(&m->win32_critical_section);
+#else
+	pthread_mutex_unlock(&m->pthread_mutex);
+#endif
 }
 
 
@@ -8164,7 +8158,7 @@ gb_inline isize gb_printf_err_va(char const *fmt, va_list va) {
 }
 
 gb_inline isize gb_fprintf_va(struct gbFile *f, char const *fmt, va_list va) {
-	gb_local_persist char buf[4096];
+	gb_local_persist gb_thread_local char buf[4096];
 	isize len = gb_snprintf_va(buf, gb_size_of(buf), fmt, va);
 	gb_file_write(f, buf, len-1); // NOTE(bill): prevent extra whitespace
 	return len;
@@ -8172,7 +8166,7 @@ gb_inline isize gb_fprintf_va(struct gbFile *f, char const *fmt, va_list va) {
 
 
 gb_inline char *gb_bprintf_va(char const *fmt, va_list va) {
-	gb_local_persist char buffer[4096];
+	gb_local_persist gb_thread_local char buffer[4096];
 	gb_snprintf_va(buffer, gb_size_of(buffer), fmt, va);
 	return buffer;
 }
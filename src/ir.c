@@ -30,7 +30,7 @@ typedef struct irModule {
 	String layout;
 	// String triple;
 
-	MapEntity             min_dep_map; // Key: Entity *
+	EntitySet             min_dep_set;
 	MapIrValue            values;      // Key: Entity *
 	MapIrValue            members;     // Key: String
 	MapString             entity_names;  // Key: Entity * of the typename
@@ -562,10 +562,11 @@ struct irDebugInfo {
 
 typedef struct irGen {
 	irModule module;
-	gbFile   output_file;
+	gbFile   output_file;  // NOTE: Only opened with `keep_temps`
 	bool     opt_called;
 	String   output_base;
 	String   output_name;
+	isize    output_count; // NOTE: Number of modules written by `print_llvm_ir`, see `-backend-jobs`
 } irGen;
 
 
@@ -771,7 +772,7 @@ irValue *ir_value_global(gbAllocator a, Entity *e, irValue *value) {
 	v->Global.entity = e;
 	v->Global.type = make_type_pointer(a, e->type);
 	v->Global.value = value;
-	array_init(&v->Global.referrers, heap_allocator()); // TODO(bill): Replace heap allocator here
+	array_init(&v->Global.referrers, tagged_allocator(MemoryTag_Ir)); // TODO(bill): Replace heap allocator here
 	return v;
 }
 irValue *ir_value_param(gbAllocator a, irProcedure *parent, Entity *e, Type *abi_type) {
@@ -791,7 +792,7 @@ irValue *ir_value_param(gbAllocator a, irProcedure *parent, Entity *e, Type *abi
 			GB_PANIC("Invalid abi type pass kind");
 		}
 	}
-	array_init(&v->Param.referrers, heap_allocator()); // TODO(bill): Replace heap allocator here
+	array_init(&v->Param.referrers, tagged_allocator(MemoryTag_Ir)); // TODO(bill): Replace heap allocator here
 	return v;
 }
 irValue *ir_value_nil(gbAllocator a, Type *type) {
@@ -823,7 +824,7 @@ irValue *ir_instr_local(irProcedure *p, Entity *e, bool zero_initialized) {
 	i->Local.type = make_type_pointer(p->module->allocator, e->type);
 	i->Local.zero_initialized = zero_initialized;
 	i->Local.alignment = type_align_of(p->module->allocator, e->type);
-	array_init(&i->Local.referrers, heap_allocator()); // TODO(bill): Replace heap allocator here
+	array_init(&i->Local.referrers, tagged_allocator(MemoryTag_Ir)); // TODO(bill): Replace heap allocator here
 	ir_module_add_value(p->module, e, v);
 	return v;
 }
@@ -1108,11 +1109,11 @@ irValue *ir_value_procedure(gbAllocator a, irModule *m, Entity *entity, Type *ty
 	v->Proc.type_expr = type_expr;
 	v->Proc.body   = body;
 	v->Proc.name   = name;
-	array_init(&v->Proc.referrers, heap_allocator()); // TODO(bill): replace heap allocator
+	array_init(&v->Proc.referrers, tagged_allocator(MemoryTag_Ir)); // TODO(bill): replace heap allocator
 
 	Type *t = base_type(type);
 	GB_ASSERT(is_type_proc(t));
-	array_init_reserve(&v->Proc.params, heap_allocator(), t->Proc.param_count);
+	array_init_reserve(&v->Proc.params, tagged_allocator(MemoryTag_Ir), t->Proc.param_count);
 
 	return v;
 }
@@ -1136,10 +1137,8 @@ irValue *ir_generate_array(irModule *m, Type *elem_type, i64 count, String prefi
 irBlock *ir_new_block(irProcedure *proc, AstNode *node, char *label) {
 	Scope *scope = NULL;
 	if (node != NULL) {
-		Scope **found = map_scope_get(&proc->module->info->scopes, hash_pointer(node));
-		if (found) {
-			scope = *found;
-		} else {
+		scope = scope_of_node(proc->module->info, node);
+		if (scope == NULL) {
 			GB_PANIC("Block scope not found for %.*s", LIT(ast_node_strings[node->kind]));
 		}
 	}
@@ -1152,11 +1151,11 @@ irBlock *ir_new_block(irProcedure *proc, AstNode *node, char *label) {
 	// TODO(bill): Is this correct or even needed?
 	v->Block.scope_index = proc->scope_index;
 
-	array_init(&v->Block.instrs, heap_allocator());
-	array_init(&v->Block.locals, heap_allocator());
+	array_init(&v->Block.instrs, tagged_allocator(MemoryTag_Ir));
+	array_init(&v->Block.locals, tagged_allocator(MemoryTag_Ir));
 
-	array_init(&v->Block.preds,  heap_allocator());
-	array_init(&v->Block.succs,  heap_allocator());
+	array_init(&v->Block.preds,  tagged_allocator(MemoryTag_Ir));
+	array_init(&v->Block.succs,  tagged_allocator(MemoryTag_Ir));
 
 	irBlock *block = &v->Block;
 	return block;
@@ -1292,9 +1291,8 @@ irValue *ir_add_local(irProcedure *proc, Entity *e, AstNode *expr) {
 }
 
 irValue *ir_add_local_for_identifier(irProcedure *proc, AstNode *name, bool zero_initialized) {
-	Entity **found = map_entity_get(&proc->module->info->definitions, hash_pointer(name));
-	if (found) {
-		Entity *e = *found;
+	Entity *e = definition_of_ident(proc->module->info, name);
+	if (e != NULL) {
 		ir_emit_comment(proc, e->token.string);
 		return ir_add_local(proc, e, name);
 	}
@@ -3042,9 +3040,9 @@ irValue *ir_emit_union_cast(irProcedure *proc, irValue *value, Type *type, Token
 		irValue **args = gb_alloc_array(a, irValue *, 6);
 		args[0] = ok;
 
-		args[1] = ir_const_string(a, pos.file);
-		args[2] = ir_const_int(a, pos.line);
-		args[3] = ir_const_int(a, pos.column);
+		args[1] = ir_const_string(a, token_pos_file(pos));
+		args[2] = ir_const_int(a, token_pos_line(pos));
+		args[3] = ir_const_int(a, token_pos_column(pos));
 
 		args[4] = ir_type_info(proc, src_type);
 		args[5] = ir_type_info(proc, dst_type);
@@ -3096,9 +3094,9 @@ irAddr ir_emit_any_cast_addr(irProcedure *proc, irValue *value, Type *type, Toke
 		irValue **args = gb_alloc_array(a, irValue *, 6);
 		args[0] = ok;
 
-		args[1] = ir_const_string(a, pos.file);
-		args[2] = ir_const_int(a, pos.line);
-		args[3] = ir_const_int(a, pos.column);
+		args[1] = ir_const_string(a, token_pos_file(pos));
+		args[2] = ir_const_int(a, token_pos_line(pos));
+		args[3] = ir_const_int(a, token_pos_column(pos));
 
 		args[4] = any_ti;
 		args[5] = ti_ptr;
@@ -3319,7 +3317,9 @@ String ir_mangle_name(irGen *s, String path, Entity *e) {
 		new_name_len += extra-1;
 	}
 
-	return make_string(new_name, new_name_len-1);
+	// NOTE: Interned so keys into `members` made from this name compare by pointer
+	Atom atom = intern_string(make_string(new_name, new_name_len-1));
+	return atom_string(atom);
 }
 
 
@@ -3342,9 +3342,8 @@ void ir_mangle_add_sub_type_name(irModule *m, Entity *field, String parent) {
 
 irBranchBlocks ir_lookup_branch_blocks(irProcedure *proc, AstNode *ident) {
 	GB_ASSERT(ident->kind == AstNode_Ident);
-	Entity **found = map_entity_get(&proc->module->info->uses, hash_pointer(ident));
-	GB_ASSERT(found != NULL);
-	Entity *e = *found;
+	Entity *e = use_of_ident(proc->module->info, ident);
+	GB_ASSERT(e != NULL);
 	GB_ASSERT(e->kind == Entity_Label);
 	for_array(i, proc->branch_blocks) {
 		irBranchBlocks *b = &proc->branch_blocks.e[i];
@@ -3486,12 +3485,12 @@ irValue *ir_build_expr(irProcedure *proc, AstNode *expr) {
 	switch (expr->kind) {
 	case_ast_node(bl, BasicLit, expr);
 		TokenPos pos = bl->pos;
-		GB_PANIC("Non-constant basic literal %.*s(%td:%td) - %.*s", LIT(pos.file), pos.line, pos.column, LIT(token_strings[bl->kind]));
+		GB_PANIC("Non-constant basic literal %.*s(%td:%td) - %.*s", LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos), LIT(token_strings[bl->kind]));
 	case_end;
 
 	case_ast_node(bd, BasicDirective, expr);
 		TokenPos pos = bd->token.pos;
-		GB_PANIC("Non-constant basic literal %.*s(%td:%td) - %.*s", LIT(pos.file), pos.line, pos.column, LIT(bd->name));
+		GB_PANIC("Non-constant basic literal %.*s(%td:%td) - %.*s", LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos), LIT(bd->name));
 	case_end;
 
 	case_ast_node(i, Implicit, expr);
@@ -3499,12 +3498,12 @@ irValue *ir_build_expr(irProcedure *proc, AstNode *expr) {
 	case_end;
 
 	case_ast_node(i, Ident, expr);
-		Entity *e = *map_entity_get(&proc->module->info->uses, hash_pointer(expr));
+		Entity *e = use_of_ident(proc->module->info, expr);
 		if (e->kind == Entity_Builtin) {
 			Token token = ast_node_token(expr);
 			GB_PANIC("TODO(bill): ir_build_single_expr Entity_Builtin `%.*s`\n"
 			         "\t at %.*s(%td:%td)", LIT(builtin_procs[e->Builtin.id].name),
-			         LIT(token.pos.file), token.pos.line, token.pos.column);
+			         LIT(token_pos_file(token.pos)), token_pos_line(token.pos), token_pos_column(token.pos));
 			return NULL;
 		} else if (e->kind == Entity_Nil) {
 			return ir_value_nil(proc->module->allocator, tv.type);
@@ -3712,7 +3711,7 @@ irValue *ir_build_expr(irProcedure *proc, AstNode *expr) {
 
 
 	case_ast_node(ce, CallExpr, expr);
-		if (map_tav_get(&proc->module->info->types, hash_pointer(ce->proc))->mode == Addressing_Type) {
+		if (type_and_value_of_expr(proc->module->info, ce->proc).mode == Addressing_Type) {
 			GB_ASSERT(ce->args.count == 1);
 			irValue *x = ir_build_expr(proc, ce->args.e[0]);
 			irValue *y = ir_emit_conv(proc, x, tv.type);
@@ -3721,9 +3720,8 @@ irValue *ir_build_expr(irProcedure *proc, AstNode *expr) {
 
 		AstNode *p = unparen_expr(ce->proc);
 		if (p->kind == AstNode_Ident) {
-			Entity **found = map_entity_get(&proc->module->info->uses, hash_pointer(p));
-			if (found && (*found)->kind == Entity_Builtin) {
-				Entity *e = *found;
+			Entity *e = use_of_ident(proc->module->info, p);
+			if (e != NULL && e->kind == Entity_Builtin) {
 				switch (e->Builtin.id) {
 				case BuiltinProc_type_info: {
 					Type *t = default_type(type_of_expr(proc->module->info, ce->args.e[0]));
@@ -4078,7 +4076,7 @@ irValue *ir_build_expr(irProcedure *proc, AstNode *expr) {
 					{
 						TokenPos pos = ast_node_token(ce->args.e[0]).pos;
 						GB_ASSERT_MSG(is_type_pointer(type), "%.*s(%td) %s",
-						              LIT(pos.file), pos.line,
+						              LIT(token_pos_file(pos)), token_pos_line(pos),
 						              type_to_string(type));
 					}
 					type = base_type(type_deref(type));
@@ -4111,7 +4109,7 @@ irValue *ir_build_expr(irProcedure *proc, AstNode *expr) {
 					}
 
 					irValue **args = gb_alloc_array(proc->module->allocator, irValue *, arg_count);
-					bool vari_expand = ce->ellipsis.pos.line != 0;
+					bool vari_expand = ce->ellipsis.pos.file_id != 0;
 
 					for_array(i, ce->args) {
 						irValue *a = ir_build_expr(proc, ce->args.e[i]);
@@ -4215,9 +4213,9 @@ irValue *ir_build_expr(irProcedure *proc, AstNode *expr) {
 
 
 					irValue **args = gb_alloc_array(proc->module->allocator, irValue *, 4);
-					args[0] = ir_const_string(proc->module->allocator, pos.file);
-					args[1] = ir_const_int(proc->module->allocator, pos.line);
-					args[2] = ir_const_int(proc->module->allocator, pos.column);
+					args[0] = ir_const_string(proc->module->allocator, token_pos_file(pos));
+					args[1] = ir_const_int(proc->module->allocator, token_pos_line(pos));
+					args[2] = ir_const_int(proc->module->allocator, token_pos_column(pos));
 					args[3] = ir_const_string(proc->module->allocator, expr_str);
 					ir_emit_global_call(proc, "__assert", args, 4);
 
@@ -4236,9 +4234,9 @@ irValue *ir_build_expr(irProcedure *proc, AstNode *expr) {
 					TokenPos pos = token.pos;
 
 					irValue **args = gb_alloc_array(proc->module->allocator, irValue *, 4);
-					args[0] = ir_const_string(proc->module->allocator, pos.file);
-					args[1] = ir_const_int(proc->module->allocator, pos.line);
-					args[2] = ir_const_int(proc->module->allocator, pos.column);
+					args[0] = ir_const_string(proc->module->allocator, token_pos_file(pos));
+					args[1] = ir_const_int(proc->module->allocator, token_pos_line(pos));
+					args[2] = ir_const_int(proc->module->allocator, token_pos_column(pos));
 					args[3] = msg;
 					ir_emit_global_call(proc, "__panic", args, 4);
 
@@ -4459,7 +4457,7 @@ irValue *ir_build_expr(irProcedure *proc, AstNode *expr) {
 		}
 		irValue **args = gb_alloc_array(proc->module->allocator, irValue *, arg_count);
 		bool variadic = proc_type_->Proc.variadic;
-		bool vari_expand = ce->ellipsis.pos.line != 0;
+		bool vari_expand = ce->ellipsis.pos.file_id != 0;
 
 		for_array(i, ce->args) {
 			irValue *a = ir_build_expr(proc, ce->args.e[i]);
@@ -5233,7 +5231,7 @@ irAddr ir_build_addr(irProcedure *proc, AstNode *expr) {
 	         "\tAstNode: %.*s @ "
 	         "%.*s(%td:%td)\n",
 	         LIT(ast_node_strings[expr->kind]),
-	         LIT(token_pos.file), token_pos.line, token_pos.column);
+	         LIT(token_pos_file(token_pos)), token_pos_line(token_pos), token_pos_column(token_pos));
 
 
 	return ir_addr(NULL);
@@ -5565,9 +5563,8 @@ void ir_build_range_interval(irProcedure *proc, AstNodeBinaryExpr *node, Type *v
 }
 
 void ir_store_type_case_implicit(irProcedure *proc, AstNode *clause, irValue *value) {
-	Entity **found = map_entity_get(&proc->module->info->implicits, hash_pointer(clause));
-	GB_ASSERT(found != NULL);
-	Entity *e = *found; GB_ASSERT(e != NULL);
+	Entity *e = implicit_entity_of_node(proc->module->info, clause);
+	GB_ASSERT(e != NULL);
 	irValue *x = ir_add_local(proc, e, NULL);
 	ir_emit_store(proc, x, value);
 }
@@ -5692,7 +5689,7 @@ void ir_build_stmt_internal(irProcedure *proc, AstNode *node) {
 					if (pd->body != NULL) {
 						CheckerInfo *info = proc->module->info;
 
-						if (map_entity_get(&proc->module->min_dep_map, hash_pointer(e)) == NULL) {
+						if (!entity_set_has(&proc->module->min_dep_set, e)) {
 							// NOTE(bill): Nothing depends upon it so doesn't need to be built
 							break;
 						}
@@ -6352,12 +6349,8 @@ void ir_build_stmt_internal(irProcedure *proc, AstNode *node) {
 				ir_start_block(proc, next);
 			}
 
-			Entity *case_entity = NULL;
-			{
-				Entity **found = map_entity_get(&proc->module->info->implicits, hash_pointer(clause));
-				GB_ASSERT(found != NULL);
-				case_entity = *found;
-			}
+			Entity *case_entity = implicit_entity_of_node(proc->module->info, clause);
+			GB_ASSERT(case_entity != NULL);
 
 
 			irValue *value = parent_value;
@@ -6519,10 +6512,10 @@ void ir_number_proc_registers(irProcedure *proc) {
 void ir_begin_procedure_body(irProcedure *proc) {
 	array_add(&proc->module->procs, proc);
 
-	array_init(&proc->blocks,           heap_allocator());
-	array_init(&proc->defer_stmts,      heap_allocator());
-	array_init(&proc->children,         heap_allocator());
-	array_init(&proc->branch_blocks,    heap_allocator());
+	array_init(&proc->blocks,           tagged_allocator(MemoryTag_Ir));
+	array_init(&proc->defer_stmts,      tagged_allocator(MemoryTag_Ir));
+	array_init(&proc->children,         tagged_allocator(MemoryTag_Ir));
+	array_init(&proc->branch_blocks,    tagged_allocator(MemoryTag_Ir));
 
 	DeclInfo **found = map_decl_info_get(&proc->module->info->entities, hash_pointer(proc->entity));
 	if (found != NULL) {
@@ -6618,7 +6611,7 @@ void ir_build_proc(irValue *value, irProcedure *parent) {
 		irModule *m = proc->module;
 		CheckerInfo *info = m->info;
 		Entity *e = proc->entity;
-		String filename = e->token.pos.file;
+		String filename = token_pos_file(e->token.pos);
 		AstFile **found = map_ast_file_get(&info->files, hash_string(filename));
 		GB_ASSERT(found != NULL);
 		AstFile *f = *found;
@@ -6683,19 +6676,19 @@ void ir_init_module(irModule *m, Checker *c) {
 	// TODO(bill): Determine a decent size for the arena
 	isize token_count = c->parser->total_token_count;
 	isize arena_size = 4 * token_count * gb_size_of(irValue);
-	gb_arena_init_from_allocator(&m->arena, heap_allocator(), arena_size);
-	gb_arena_init_from_allocator(&m->tmp_arena, heap_allocator(), arena_size);
+	gb_arena_init_from_allocator(&m->arena, tagged_allocator(MemoryTag_Ir), arena_size);
+	gb_arena_init_from_allocator(&m->tmp_arena, tagged_allocator(MemoryTag_Ir), arena_size);
 	m->allocator     = gb_arena_allocator(&m->arena);
 	m->tmp_allocator = gb_arena_allocator(&m->tmp_arena);
 	m->info = &c->info;
 
-	map_ir_value_init(&m->values,  heap_allocator());
-	map_ir_value_init(&m->members, heap_allocator());
-	map_ir_debug_info_init(&m->debug_info, heap_allocator());
-	map_string_init(&m->entity_names, heap_allocator());
-	array_init(&m->procs,    heap_allocator());
-	array_init(&m->procs_to_generate, heap_allocator());
-	array_init(&m->foreign_library_paths, heap_allocator());
+	map_ir_value_init(&m->values,  tagged_allocator(MemoryTag_Ir));
+	map_ir_value_init(&m->members, tagged_allocator(MemoryTag_Ir));
+	map_ir_debug_info_init(&m->debug_info, tagged_allocator(MemoryTag_Ir));
+	map_string_init(&m->entity_names, tagged_allocator(MemoryTag_Ir));
+	array_init(&m->procs,    tagged_allocator(MemoryTag_Ir));
+	array_init(&m->procs_to_generate, tagged_allocator(MemoryTag_Ir));
+	array_init(&m->foreign_library_paths, tagged_allocator(MemoryTag_Ir));
 
 	// Default states
 	m->stmt_state_flags = 0;
@@ -6841,17 +6834,33 @@ bool ir_gen_init(irGen *s, Checker *c) {
 	int dir_pos = cast(int)string_extension_position(init_fullpath);
 	s->output_name = filename_from_path(init_fullpath);
 	s->output_base = make_string(init_fullpath.text, pos);
-	gbFileError err = gb_file_create(&s->output_file, gb_bprintf("%.*s.ll", pos, init_fullpath.text));
-	if (err != gbFileError_None) {
-		return false;
+	if (build_context.keep_temps) {
+		gbFileError err = gb_file_create(&s->output_file, gb_bprintf("%.*s.ll", pos, init_fullpath.text));
+		if (err != gbFileError_None) {
+			return false;
+		}
 	}
 
 	return true;
 }
 
+// NOTE: The path, without extension, of the files for module `index` of a split build
+String ir_output_base(irGen *s, isize index) {
+	if (index == 0) {
+		return s->output_base;
+	}
+	char *text = gb_bprintf("%.*s.%td", LIT(s->output_base), index);
+	isize len = gb_strlen(text);
+	u8 *copy = gb_alloc_array(heap_allocator(), u8, len);
+	gb_memmove(copy, text, len);
+	return make_string(copy, len);
+}
+
 void ir_gen_destroy(irGen *s) {
 	ir_destroy_module(&s->module);
-	gb_file_close(&s->output_file);
+	if (build_context.keep_temps) {
+		gb_file_close(&s->output_file);
+	}
 }
 
 
@@ -6963,7 +6972,7 @@ void ir_gen_tree(irGen *s) {
 	array_init_reserve(&global_variables, m->tmp_allocator, global_variable_max_count);
 
 	m->entry_point_entity = entry_point;
-	m->min_dep_map = generate_minimum_dependency_map(info, entry_point);
+	m->min_dep_set = generate_minimum_dependency_set(info, entry_point);
 
 	for_array(i, info->entities.entries) {
 		MapDeclInfoEntry *entry = &info->entities.entries.e[i];
@@ -6976,7 +6985,7 @@ void ir_gen_tree(irGen *s) {
 			continue;
 		}
 
-		if (map_entity_get(&m->min_dep_map, hash_pointer(e)) == NULL) {
+		if (!entity_set_has(&m->min_dep_set, e)) {
 			// NOTE(bill): Nothing depends upon it so doesn't need to be built
 			continue;
 		}
@@ -6987,7 +6996,7 @@ void ir_gen_tree(irGen *s) {
 				// Handle later
 			} else if (scope->is_init && e->kind == Entity_Procedure && str_eq(name, str_lit("main"))) {
 			} else {
-				name = ir_mangle_name(s, e->token.pos.file, e);
+				name = ir_mangle_name(s, token_pos_file(e->token.pos), e);
 			}
 		}
 		map_string_set(&m->entity_names, hash_pointer(e), name);
@@ -7120,7 +7129,7 @@ void ir_gen_tree(irGen *s) {
 		                                 proc_params, 3,
 		                                 proc_results, 1, false, ProcCC_Std);
 
-		AstNode *body = gb_alloc_item(a, AstNode);
+		AstNode *body = alloc_ast_node(a, AstNode_Invalid);
 		Entity *e = make_entity_procedure(a, NULL, make_token_ident(name), proc_type, 0);
 		irValue *p = ir_value_procedure(a, m, e, proc_type, NULL, body, name);
 
@@ -7189,7 +7198,7 @@ void ir_gen_tree(irGen *s) {
 		                                 proc_params, 4,
 		                                 proc_results, 1, false, ProcCC_Std);
 
-		AstNode *body = gb_alloc_item(a, AstNode);
+		AstNode *body = alloc_ast_node(a, AstNode_Invalid);
 		Entity *e = make_entity_procedure(a, NULL, make_token_ident(name), proc_type, 0);
 		irValue *p = ir_value_procedure(a, m, e, proc_type, NULL, body, name);
 
@@ -7214,7 +7223,7 @@ void ir_gen_tree(irGen *s) {
 		Type *proc_type = make_type_proc(a, gb_alloc_item(a, Scope),
 		                                 NULL, 0,
 		                                 NULL, 0, false, ProcCC_Odin);
-		AstNode *body = gb_alloc_item(a, AstNode);
+		AstNode *body = alloc_ast_node(a, AstNode_Invalid);
 		Entity *e = make_entity_procedure(a, NULL, make_token_ident(name), proc_type, 0);
 		irValue *p = ir_value_procedure(a, m, e, proc_type, NULL, body, name);
 
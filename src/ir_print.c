@@ -7,6 +7,7 @@ typedef struct irFileBuffer {
 void ir_file_buffer_init(irFileBuffer *f, gbFile *output) {
 	isize size = 8*gb_virtual_memory_page_size(NULL);
 	f->vm = gb_vm_alloc(NULL, size);
+	memory_tag_add(MemoryTag_IrPrint, f->vm.size);
 	f->offset = 0;
 	f->output = output;
 }
@@ -17,6 +18,7 @@ void ir_file_buffer_destroy(irFileBuffer *f) {
 		gb_file_write(f->output, f->vm.data, f->offset);
 	}
 
+	memory_tag_add(MemoryTag_IrPrint, -f->vm.size);
 	gb_vm_free(f->vm);
 }
 
@@ -1333,17 +1335,17 @@ void ir_print_instr(irFileBuffer *f, irModule *m, irValue *value) {
 		ir_fprintf(f, "call void ");
 		ir_print_encoded_global(f, str_lit("__bounds_check_error"), false);
 		ir_fprintf(f, "(");
-		ir_print_compound_element(f, m, exact_value_string(bc->pos.file), t_string);
+		ir_print_compound_element(f, m, exact_value_string(token_pos_file(bc->pos)), t_string);
 		ir_fprintf(f, ", ");
 
 		ir_print_type(f, m, t_int);
 		ir_fprintf(f, " ");
-		ir_print_exact_value(f, m, exact_value_i64(bc->pos.line), t_int);
+		ir_print_exact_value(f, m, exact_value_i64(token_pos_line(bc->pos)), t_int);
 		ir_fprintf(f, ", ");
 
 		ir_print_type(f, m, t_int);
 		ir_fprintf(f, " ");
-		ir_print_exact_value(f, m, exact_value_i64(bc->pos.column), t_int);
+		ir_print_exact_value(f, m, exact_value_i64(token_pos_column(bc->pos)), t_int);
 		ir_fprintf(f, ", ");
 
 		ir_print_type(f, m, t_int);
@@ -1368,17 +1370,17 @@ void ir_print_instr(irFileBuffer *f, irModule *m, irValue *value) {
 		}
 
 		ir_fprintf(f, "(");
-		ir_print_compound_element(f, m, exact_value_string(bc->pos.file), t_string);
+		ir_print_compound_element(f, m, exact_value_string(token_pos_file(bc->pos)), t_string);
 		ir_fprintf(f, ", ");
 
 		ir_print_type(f, m, t_int);
 		ir_fprintf(f, " ");
-		ir_print_exact_value(f, m, exact_value_i64(bc->pos.line), t_int);
+		ir_print_exact_value(f, m, exact_value_i64(token_pos_line(bc->pos)), t_int);
 		ir_fprintf(f, ", ");
 
 		ir_print_type(f, m, t_int);
 		ir_fprintf(f, " ");
-		ir_print_exact_value(f, m, exact_value_i64(bc->pos.column), t_int);
+		ir_print_exact_value(f, m, exact_value_i64(token_pos_column(bc->pos)), t_int);
 		ir_fprintf(f, ", ");
 
 		ir_print_type(f, m, t_int);
@@ -1415,10 +1417,10 @@ void ir_print_instr(irFileBuffer *f, irModule *m, irValue *value) {
 		ir_print_value(f, m, dd->value, vt);
 		ir_fprintf(f, ", metadata !DILocalVariable(name: \"");
 		ir_print_escape_string(f, name, false);
-		ir_fprintf(f, "\", scope: !%d, line: %td)", di->id, pos.line);
+		ir_fprintf(f, "\", scope: !%d, line: %td)", di->id, token_pos_line(pos));
 		ir_fprintf(f, ", metadata !DIExpression()");
 		ir_fprintf(f, ")");
-		ir_fprintf(f, ", !dbg !DILocation(line: %td, column: %td, scope: !%d)", pos.line, pos.column, di->id);
+		ir_fprintf(f, ", !dbg !DILocation(line: %td, column: %td, scope: !%d)", token_pos_line(pos), token_pos_column(pos), di->id);
 
 		ir_fprintf(f, "\n"); */
 	} break;
@@ -1426,8 +1428,10 @@ void ir_print_instr(irFileBuffer *f, irModule *m, irValue *value) {
 }
 
 
-void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc) {
-	if (proc->body == NULL) {
+// NOTE: `as_declaration` declares a procedure that is defined in another module of a split build
+void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc, bool as_declaration) {
+	bool is_definition = proc->body != NULL && !as_declaration;
+	if (!is_definition) {
 		ir_fprintf(f, "declare ");
 		// if (proc->tags & ProcTag_dll_import) {
 			// ir_fprintf(f, "dllimport ");
@@ -1484,7 +1488,7 @@ void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc) {
 			if (e->flags&EntityFlag_NoAlias) {
 				ir_fprintf(f, " noalias");
 			}
-			if (proc->body != NULL) {
+			if (is_definition) {
 				if (!str_eq(e->token.string, str_lit("")) &&
 				    !str_eq(e->token.string, str_lit("_"))) {
 					ir_fprintf(f, " ");
@@ -1507,7 +1511,7 @@ void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc) {
 
 
 	if (proc->entity != NULL) {
-		if (proc->body != NULL) {
+		if (is_definition) {
 			irDebugInfo **di_ = map_ir_debug_info_get(&proc->module->debug_info, hash_pointer(proc->entity));
 			if (di_ != NULL) {
 				irDebugInfo *di = *di_;
@@ -1518,7 +1522,7 @@ void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc) {
 	}
 
 
-	if (proc->body != NULL) {
+	if (is_definition) {
 		// ir_fprintf(f, "nounwind uwtable {\n");
 
 		ir_fprintf(f, "{\n");
@@ -1540,7 +1544,7 @@ void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc) {
 	}
 
 	for_array(i, proc->children) {
-		ir_print_proc(f, m, proc->children.e[i]);
+		ir_print_proc(f, m, proc->children.e[i], as_declaration);
 	}
 }
 
@@ -1556,10 +1560,219 @@ void ir_print_type_name(irFileBuffer *f, irModule *m, irValue *v) {
 	ir_fprintf(f, "\n");
 }
 
-void print_llvm_ir(irGen *ir) {
-	irModule *m = &ir->module;
-	irFileBuffer buf = {0}, *f = &buf;
-	ir_file_buffer_init(f, &ir->output_file);
+// NOTE: Instructions in a procedure and its nested procedures, used to balance the modules
+isize ir_proc_instr_count(irProcedure *proc) {
+	isize count = 0;
+	for_array(i, proc->blocks) {
+		count += proc->blocks.e[i]->instrs.count;
+	}
+	for_array(i, proc->children) {
+		count += ir_proc_instr_count(proc->children.e[i]);
+	}
+	return count;
+}
+
+typedef struct irProcWeight {
+	isize member_index;
+	isize instr_count;
+} irProcWeight;
+
+GB_COMPARE_PROC(ir_proc_weight_cmp) {
+	irProcWeight const *x = cast(irProcWeight const *)a;
+	irProcWeight const *y = cast(irProcWeight const *)b;
+	if (x->instr_count != y->instr_count) {
+		return x->instr_count > y->instr_count ? -1 : +1;
+	}
+	return x->member_index < y->member_index ? -1 : +1;
+}
+
+// NOTE: How the program is split into several modules, see `-backend-jobs`. The procedures of
+// core/ may be given a module of their own, which is then printed so that it only changes when
+// the code generated for core changes (see `core_refs`) and its object can be cached.
+typedef struct irSplit {
+	isize   count;            // Number of modules, at most the number of procedures with a body
+	isize   member_count;     // Members that existed when the procedures were assigned
+	isize * member_partition; // Module of each such member, -1 if not a procedure with a body
+	isize   core_partition;   // -1 if core/ is not a separate module
+	MapBool core_refs;        // Names of the procedures and globals used by the core module
+} irSplit;
+
+bool ir_proc_is_core(irProcedure *proc, String core_dir) {
+	if (proc->entity == NULL) {
+		return false;
+	}
+	String file = token_pos_file(proc->entity->token.pos);
+	if (core_dir.len == 0 || file.len <= core_dir.len || !str_has_prefix(file, core_dir)) {
+		return false;
+	}
+	// NOTE: core_dir usually comes without a trailing separator, so one must follow it or a
+	// sibling such as `core_extra/` would be taken for core
+	u8 last = core_dir.text[core_dir.len-1];
+	u8 next = file.text[core_dir.len];
+	return last == '/' || last == '\\' || next == '/' || next == '\\';
+}
+
+void ir_split__add_ref(irSplit *split, irModule *m, irValue *v) {
+	if (v == NULL) {
+		return;
+	}
+	switch (v->kind) {
+	case irValue_Proc:
+		map_bool_set(&split->core_refs, hash_string(v->Proc.name), true);
+		break;
+	case irValue_Global:
+		map_bool_set(&split->core_refs, hash_string(ir_get_global_name(m, v)), true);
+		break;
+	case irValue_ConstantSlice:
+		ir_split__add_ref(split, m, v->ConstantSlice.backing_array);
+		break;
+	}
+}
+
+void ir_split__add_proc_refs(irSplit *split, irModule *m, irProcedure *proc) {
+	for_array(i, proc->blocks) {
+		irBlock *block = proc->blocks.e[i];
+		for_array(j, block->instrs) {
+			irInstr *instr = &block->instrs.e[j]->Instr;
+			switch (instr->kind) {
+			case irInstr_ZeroInit:         ir_split__add_ref(split, m, instr->ZeroInit.address);           break;
+			case irInstr_Store:
+				ir_split__add_ref(split, m, instr->Store.address);
+				ir_split__add_ref(split, m, instr->Store.value);
+				break;
+			case irInstr_Load:             ir_split__add_ref(split, m, instr->Load.address);               break;
+			case irInstr_PtrOffset:
+				ir_split__add_ref(split, m, instr->PtrOffset.address);
+				ir_split__add_ref(split, m, instr->PtrOffset.offset);
+				break;
+			case irInstr_ArrayElementPtr:
+				ir_split__add_ref(split, m, instr->ArrayElementPtr.address);
+				ir_split__add_ref(split, m, instr->ArrayElementPtr.elem_index);
+				break;
+			case irInstr_StructElementPtr:   ir_split__add_ref(split, m, instr->StructElementPtr.address);   break;
+			case irInstr_StructExtractValue: ir_split__add_ref(split, m, instr->StructExtractValue.address); break;
+			case irInstr_UnionTagPtr:        ir_split__add_ref(split, m, instr->UnionTagPtr.address);        break;
+			case irInstr_UnionTagValue:      ir_split__add_ref(split, m, instr->UnionTagValue.address);      break;
+			case irInstr_Conv:               ir_split__add_ref(split, m, instr->Conv.value);                 break;
+			case irInstr_If:                 ir_split__add_ref(split, m, instr->If.cond);                    break;
+			case irInstr_Return:             ir_split__add_ref(split, m, instr->Return.value);               break;
+			case irInstr_Select:
+				ir_split__add_ref(split, m, instr->Select.cond);
+				ir_split__add_ref(split, m, instr->Select.true_value);
+				ir_split__add_ref(split, m, instr->Select.false_value);
+				break;
+			case irInstr_Phi:
+				for_array(k, instr->Phi.edges) {
+					ir_split__add_ref(split, m, instr->Phi.edges.e[k]);
+				}
+				break;
+			case irInstr_UnaryOp:            ir_split__add_ref(split, m, instr->UnaryOp.expr);               break;
+			case irInstr_BinaryOp:
+				ir_split__add_ref(split, m, instr->BinaryOp.left);
+				ir_split__add_ref(split, m, instr->BinaryOp.right);
+				break;
+			case irInstr_Call:
+				ir_split__add_ref(split, m, instr->Call.value);
+				ir_split__add_ref(split, m, instr->Call.return_ptr);
+				for (isize k = 0; k < instr->Call.arg_count; k++) {
+					ir_split__add_ref(split, m, instr->Call.args[k]);
+				}
+				break;
+			case irInstr_BoundsCheck:
+				ir_split__add_ref(split, m, instr->BoundsCheck.index);
+				ir_split__add_ref(split, m, instr->BoundsCheck.len);
+				break;
+			case irInstr_SliceBoundsCheck:
+				ir_split__add_ref(split, m, instr->SliceBoundsCheck.low);
+				ir_split__add_ref(split, m, instr->SliceBoundsCheck.high);
+				ir_split__add_ref(split, m, instr->SliceBoundsCheck.max);
+				break;
+			}
+		}
+	}
+	for_array(i, proc->children) {
+		ir_split__add_proc_refs(split, m, proc->children.e[i]);
+	}
+}
+
+// NOTE: Assigns each procedure with a body to one of at most `count` modules, largest first to
+// the module with the fewest instructions so far. Nested procedures stay with their parent. With
+// `separate_core`, the procedures of core/ go to an extra module after the others instead.
+void ir_split_init(irSplit *split, irModule *m, isize count, bool separate_core) {
+	String core_dir = {0};
+	if (separate_core) {
+		core_dir = get_fullpath_core(heap_allocator(), str_lit(""));
+	}
+	split->core_partition = -1;
+	map_bool_init(&split->core_refs, tagged_allocator(MemoryTag_IrPrint));
+
+	isize member_count = m->members.entries.count;
+	isize *member_partition = gb_alloc_array(tagged_allocator(MemoryTag_IrPrint), isize, member_count);
+	Array(irProcWeight) weights = {0};
+	array_init(&weights, tagged_allocator(MemoryTag_IrPrint));
+
+	for_array(member_index, m->members.entries) {
+		irValue *v = m->members.entries.e[member_index].value;
+		member_partition[member_index] = -1;
+		if (v->kind == irValue_Proc && v->Proc.body != NULL) {
+			if (separate_core && ir_proc_is_core(&v->Proc, core_dir)) {
+				member_partition[member_index] = -2; // NOTE: Fixed below once `count` is known
+				ir_split__add_proc_refs(split, m, &v->Proc);
+				continue;
+			}
+			irProcWeight w = {member_index, ir_proc_instr_count(&v->Proc)};
+			array_add(&weights, w);
+		}
+	}
+
+	count = gb_clamp(count, 1, gb_max(weights.count, 1));
+	gb_sort_array(weights.e, weights.count, ir_proc_weight_cmp);
+
+	isize *loads = gb_alloc_array(tagged_allocator(MemoryTag_IrPrint), isize, count);
+	gb_zero_size(loads, gb_size_of(isize)*count);
+	for_array(i, weights) {
+		isize lightest = 0;
+		for (isize p = 1; p < count; p++) {
+			if (loads[p] < loads[lightest]) {
+				lightest = p;
+			}
+		}
+		loads[lightest] += weights.e[i].instr_count + 1;
+		member_partition[weights.e[i].member_index] = lightest;
+	}
+
+	gb_free(heap_allocator(), loads);
+	array_free(&weights);
+
+	for (isize i = 0; i < member_count; i++) {
+		if (member_partition[i] == -2) {
+			split->core_partition = count;
+			member_partition[i] = count;
+		}
+	}
+	if (split->core_partition >= 0) {
+		count += 1;
+	}
+
+	split->count            = count;
+	split->member_count     = member_count;
+	split->member_partition = member_partition;
+}
+
+void ir_split_destroy(irSplit *split) {
+	gb_free(heap_allocator(), split->member_partition);
+	map_bool_destroy(&split->core_refs);
+}
+
+// NOTE: Prints one module of the program. If `split` is NULL, the whole program is printed as a
+// single module. Otherwise only the procedures assigned to `partition` are defined and the rest
+// are declared. The globals are defined in module 0 and declared elsewhere, and private ones are
+// made hidden so the other modules can still refer to them. Globals created while printing (the
+// string data of constants) are private to the module that created them.
+void ir_print_module(irFileBuffer *f, irModule *m, isize partition, irSplit *split) {
+	isize first_new_member = m->members.entries.count;
+	// NOTE: The core module only declares what it uses, so that changes elsewhere leave it as is
+	bool is_core_module = split != NULL && partition == split->core_partition;
 
 	ir_print_encoded_local(f, str_lit("..string"));
 	ir_fprintf(f, " = type {i8*, ");
@@ -1608,8 +1821,14 @@ void print_llvm_ir(irGen *ir) {
 			continue;
 		}
 
+		if (is_core_module && map_bool_get(&split->core_refs, hash_string(v->Proc.name)) == NULL) {
+			continue;
+		}
+
 		if (v->Proc.body == NULL) {
-			ir_print_proc(f, m, &v->Proc);
+			ir_print_proc(f, m, &v->Proc, false);
+		} else if (split != NULL && split->member_partition[member_index] != partition) {
+			ir_print_proc(f, m, &v->Proc, true);
 		}
 	}
 
@@ -1620,8 +1839,11 @@ void print_llvm_ir(irGen *ir) {
 			continue;
 		}
 
-		if (v->Proc.body != NULL) {
-			ir_print_proc(f, m, &v->Proc);
+		if (v->Proc.body == NULL) {
+			continue;
+		}
+		if (split == NULL || split->member_partition[member_index] == partition) {
+			ir_print_proc(f, m, &v->Proc, false);
 		}
 	}
 
@@ -1640,16 +1862,30 @@ void print_llvm_ir(irGen *ir) {
 			// in_global_scope = value->Global.name_is_not_mangled;
 		}
 
+		bool is_shared   = split != NULL && member_index < split->member_count;
+		bool is_external = g->is_foreign || (is_shared && partition != 0);
+		if (split != NULL && !is_shared && member_index < first_new_member) {
+			// NOTE: Created while printing an earlier module and only used there
+			continue;
+		}
+		if (is_core_module && is_shared &&
+		    map_bool_get(&split->core_refs, hash_string(ir_get_global_name(m, v))) == NULL) {
+			continue;
+		}
+
 		ir_print_encoded_global(f, ir_get_global_name(m, v), in_global_scope);
 		ir_fprintf(f, " = ");
-		if (g->is_foreign) {
+		if (is_external) {
 			ir_fprintf(f, "external ");
 		}
+		if (is_shared && g->is_private) {
+			ir_fprintf(f, "hidden ");
+		}
 		if (g->is_thread_local) {
 			ir_fprintf(f, "thread_local ");
 		}
 
-		if (g->is_private) {
+		if (!is_shared && g->is_private) {
 			ir_fprintf(f, "private ");
 		}
 		if (g->is_constant) {
@@ -1664,7 +1900,7 @@ void print_llvm_ir(irGen *ir) {
 
 		ir_print_type(f, m, g->entity->type);
 		ir_fprintf(f, " ");
-		if (!g->is_foreign) {
+		if (!is_external) {
 			if (g->value != NULL) {
 				ir_print_value(f, m, g->value, g->entity->type);
 			} else {
@@ -1729,7 +1965,7 @@ void print_llvm_ir(irGen *ir) {
 				            ")",
 				            LIT(di->Proc.name),
 				            di->Proc.file->id,
-				            di->Proc.pos.line);
+				            token_pos_line(di->Proc.pos));
 				break;
 
 			case irDebugInfo_AllProcs:
@@ -1747,5 +1983,38 @@ void print_llvm_ir(irGen *ir) {
 		}
 	}
 #endif
-	ir_file_buffer_destroy(f);
+}
+
+// NOTE: Prints module `partition` of the program to `output`. A split with a single module prints
+// the program exactly as an unsplit build does.
+void ir_print_partition(irGen *ir, irSplit *split, isize partition, gbFile *output) {
+	irFileBuffer buf = {0};
+	ir_file_buffer_init(&buf, output);
+	ir_print_module(&buf, &ir->module, partition, split->count > 1 ? split : NULL);
+	ir_file_buffer_destroy(&buf);
+}
+
+// NOTE: Writes each module to a file, the first to the usual `.ll` file and the others to `.1.ll`,
+// `.2.ll`, etc. When the backend is pipelined (no `-keep-temps`), main prints into pipes instead.
+void print_llvm_ir(irGen *ir) {
+	irSplit split = {0};
+	ir_split_init(&split, &ir->module, build_context.backend_jobs, false);
+	ir->output_count = split.count;
+	for (isize partition = 0; partition < split.count; partition++) {
+		gbFile file = {0};
+		gbFile *output = &ir->output_file;
+		if (partition > 0) {
+			String base = ir_output_base(ir, partition);
+			gbFileError err = gb_file_create(&file, gb_bprintf("%.*s.ll", LIT(base)));
+			GB_ASSERT_MSG(err == gbFileError_None, "Unable to create %.*s.ll", LIT(base));
+			output = &file;
+		}
+
+		ir_print_partition(ir, &split, partition, output);
+
+		if (partition > 0) {
+			gb_file_close(&file);
+		}
+	}
+	ir_split_destroy(&split);
 }
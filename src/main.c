@@ -14,6 +14,10 @@ extern "C" {
 #include "ir.c"
 #include "ir_opt.c"
 #include "ir_print.c"
+#include "exec.c"
+#include "cache.c"
+#include "server.c"
+#include "bench.c"
 // #include "vm.c"
 
 #if defined(GB_SYSTEM_WINDOWS)
@@ -48,6 +52,7 @@ i32 system_exec_command_line_app(char *name, bool is_silent, char *fmt, ...) {
 	                   &start_info, &pi)) {
 		WaitForSingleObject(pi.hProcess, INFINITE);
 		GetExitCodeProcess(pi.hProcess, cast(DWORD *)&exit_code);
+		win32_child_cpu_time += win32_process_cpu_time(pi.hProcess);
 
 		CloseHandle(pi.hProcess);
 		CloseHandle(pi.hThread);
@@ -60,51 +65,6 @@ i32 system_exec_command_line_app(char *name, bool is_silent, char *fmt, ...) {
 	gb_temp_arena_memory_end(tmp);
 	return exit_code;
 }
-#elif defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
-i32 system_exec_command_line_app(char *name, bool is_silent, char *fmt, ...) {
-
-	char cmd_line[4096] = {0};
-	isize cmd_len;
-	va_list va;
-	String cmd;
-	i32 exit_code = 0;
-
-	va_start(va, fmt);
-	cmd_len = gb_snprintf_va(cmd_line, gb_size_of(cmd_line), fmt, va);
-	va_end(va);
-	cmd = make_string(cast(u8 *)&cmd_line, cmd_len-1);
-
-	exit_code = system(&cmd_line[0]);
-
-	// pid_t pid = fork();
-	// int status = 0;
-
-	// if(pid == 0) {
-	// 	// in child, pid == 0.
-	// 	int ret = execvp(cmd.text, (char* const*) cmd.text);
-
-	// 	if(ret == -1) {
-	// 		gb_printf_err("Failed to execute command:\n\t%s\n", cmd_line);
-
-	// 		// we're in the child, so returning won't do us any good -- just quit.
-	// 		exit(-1);
-	// 	}
-
-	// 	// unreachable
-	// 	abort();
-	// } else {
-	// 	// wait for child to finish, then we can continue cleanup
-
-	// 	int s = 0;
-	// 	waitpid(pid, &s, 0);
-
-	// 	status = WEXITSTATUS(s);
-	// }
-
-	// exit_code = status;
-
-	return exit_code;
-}
 #endif
 
 
@@ -131,50 +91,471 @@ void usage(char *argv0) {
 	print_usage_line(1, "build_dll    compile .odin file as dll");
 	print_usage_line(1, "run          compile and run .odin file");
 	print_usage_line(1, "version      print version");
+	print_usage_line(1, "serve        keep the core library parsed and build on request, `serve <socket>` (see -server)");
+	print_usage_line(1, "bench_tokenizer");
+	print_usage_line(1, "             measure tokenizer throughput on the given files, e.g. `bench_tokenizer core/*.odin`");
+	print_usage_line(1, "bench_generate");
+	print_usage_line(1, "             write a synthetic project, `bench_generate <dir> [-files=n] [-procs=n] [-depth=n] [-overloads=n] [-usings=n] [-fanout=n]`");
+	print_usage_line(1, "bench        build the synthetic benchmarks and compare with a baseline (-save-baseline)");
+	print_usage_line(0, "Flags:");
+	print_usage_line(1, "-thread-count=<n>   number of threads used to parse files and check procedure bodies (default: core count)");
+	print_usage_line(1, "-token-array        tokenize each file fully before parsing it");
+	print_usage_line(1, "-backend-jobs=<n>   split the program into <n> modules for opt and llc (default: 1)");
+	print_usage_line(1, "-profile=<p>        debug (default), release or release-native (optimized for this cpu)");
+	print_usage_line(1, "-cache-dir=<dir>    where the compiled core library is cached (default: ~/.cache/odin)");
+	print_usage_line(1, "-no-core-cache      always compile the core library");
+	print_usage_line(1, "-server=<socket>    have a running `serve` do the build, or build here if none is running");
+	print_usage_line(1, "-keep-temps         write the .ll and .bc files rather than piping them to opt and llc");
+	print_usage_line(1, "-show-timings       print the time, throughput and peak memory of each phase");
+	print_usage_line(1, "-timings-json=<f>   write the same report as JSON to the file <f>");
+	print_usage_line(1, "-show-memory        print the live and peak memory of each part of the compiler");
 }
 
-int main(int argc, char **argv) {
-	if (argc < 2) {
-		usage(argv[0]);
+// NOTE: Flags follow the file name, e.g. `odin build foo.odin -thread-count=4`
+bool parse_build_flags(int argc, char **argv, int first_flag) {
+	bool ok = true;
+	for (int i = first_flag; i < argc; i++) {
+		String flag = make_string_c(argv[i]);
+		String name = flag;
+		String value = {0};
+		for (isize j = 0; j < flag.len; j++) {
+			if (flag.text[j] == '=') {
+				name  = make_string(flag.text, j);
+				value = make_string(flag.text+j+1, flag.len-j-1);
+				break;
+			}
+		}
+
+		if (str_eq(name, str_lit("-thread-count"))) {
+			i64 count = gb_str_to_i64(cast(char *)value.text, NULL, 10);
+			if (value.len == 0 || count < 1) {
+				gb_printf_err("`%.*s` expects a positive integer\n", LIT(name));
+				ok = false;
+			} else {
+				build_context.thread_count = cast(isize)count;
+			}
+		} else if (str_eq(name, str_lit("-backend-jobs"))) {
+			i64 count = gb_str_to_i64(cast(char *)value.text, NULL, 10);
+			if (value.len == 0 || count < 1) {
+				gb_printf_err("`%.*s` expects a positive integer\n", LIT(name));
+				ok = false;
+			} else {
+				build_context.backend_jobs = cast(isize)count;
+			}
+		} else if (str_eq(name, str_lit("-profile"))) {
+			if (!set_build_profile(&build_context, value)) {
+				gb_printf_err("`%.*s` expects debug, release or release-native\n", LIT(name));
+				ok = false;
+			}
+		} else if (str_eq(name, str_lit("-cache-dir"))) {
+			if (value.len == 0) {
+				gb_printf_err("`%.*s` expects a directory\n", LIT(name));
+				ok = false;
+			} else {
+				build_context.cache_dir = value;
+			}
+		} else if (str_eq(name, str_lit("-no-core-cache"))) {
+			build_context.cache_dir = str_lit("");
+		} else if (str_eq(name, str_lit("-server"))) {
+			// NOTE: Handled by `server_forward_command` before the compiler is set up
+		} else if (str_eq(name, str_lit("-keep-temps"))) {
+			build_context.keep_temps = true;
+		} else if (str_eq(name, str_lit("-token-array"))) {
+			build_context.stream_tokens = false;
+		} else if (str_eq(name, str_lit("-show-timings"))) {
+			build_context.show_timings = true;
+		} else if (str_eq(name, str_lit("-show-memory"))) {
+			// NOTE: The tracking itself is turned on by `main`
+			build_context.show_memory = true;
+		} else if (str_eq(name, str_lit("-timings-json"))) {
+			if (value.len == 0) {
+				gb_printf_err("`%.*s` expects a file name\n", LIT(name));
+				ok = false;
+			} else {
+				build_context.timings_json_path = value;
+			}
+		} else {
+			gb_printf_err("Unknown flag: `%.*s`\n", LIT(flag));
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+String join_flags(String a, String b) {
+	a = string_trim_whitespace(a);
+	b = string_trim_whitespace(b);
+	if (a.len == 0 || b.len == 0) {
+		return a.len == 0 ? b : a;
+	}
+	u8 *text = gb_alloc_array(heap_allocator(), u8, a.len+1+b.len);
+	gb_memmove(text, a.text, a.len);
+	text[a.len] = ' ';
+	gb_memmove(text+a.len+1, b.text, b.len);
+	return make_string(text, a.len+1+b.len);
+}
+
+// NOTE: Reports the build profile with the timings so that measurements can be reproduced
+void add_build_timings_infos(Timings *t) {
+	BuildContext *bc = &build_context;
+	timings_add_info(t, str_lit("profile"),    build_profile_names[bc->profile]);
+	timings_add_info(t, str_lit("opt_flags"),  join_flags(bc->opt_flags, bc->cpu_flags));
+	u8 *llc_level_text = gb_alloc_array(heap_allocator(), u8, 8);
+	isize llc_level_len = gb_snprintf(cast(char *)llc_level_text, 8, "-O%d", bc->optimization_level);
+	String llc_level = make_string(llc_level_text, llc_level_len-1);
+	timings_add_info(t, str_lit("llc_flags"),  join_flags(join_flags(llc_level, bc->cpu_flags),
+	                                                      join_flags(bc->llc_flags, bc->profile_llc_flags)));
+	timings_add_info(t, str_lit("link_flags"), join_flags(bc->link_flags, bc->profile_link_flags));
+}
+
+void show_timings(Timings *t) {
+	if (build_context.show_timings) {
+		timings_print_all(t);
+	}
+	if (build_context.show_memory) {
+		print_memory_report();
+	}
+	if (build_context.timings_json_path.len > 0) {
+		timings_write_json(t, build_context.timings_json_path);
+	}
+}
+
+#if defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+// NOTE(zangent): This is separate because it seems that LLVM tools are packaged
+//   with the Windows version, while they will be system-provided on MacOS and GNU/Linux
+// NOTE: The input and output files are added by the caller
+void opt_args_init(ExecArgs *args) {
+	exec_args_init(args);
+	exec_arg(args, "opt");
+	exec_args_split(args, build_context.opt_flags);
+	exec_args_split(args, build_context.cpu_flags);
+	#if defined(GB_SYSTEM_OSX)
+		// This sets a requirement of Mountain Lion and up, but the compiler doesn't work without this limit.
+		// NOTE: If you change this (although this minimum is as low as you can go with Odin working)
+		//       make sure to also change the `macosx_version_min` param passed to `llc`
+		exec_arg(args, "-mtriple=x86_64-apple-macosx10.8");
+	#endif
+}
+
+void llc_args_init(ExecArgs *args, i32 optimization_level) {
+	// For more arguments: http://llvm.org/docs/CommandGuide/llc.html
+	exec_args_init(args);
+	exec_arg(args, "llc");
+	exec_arg(args, "-filetype=obj");
+	exec_arg(args, "-O%d", optimization_level);
+	exec_args_split(args, build_context.cpu_flags);
+	exec_args_split(args, build_context.llc_flags);
+	exec_args_split(args, build_context.profile_llc_flags);
+}
+
+// NOTE: With `-keep-temps`, the .ll files have been written by `print_llvm_ir`. All the modules
+// of a split build (see `-backend-jobs`) go through opt, then all of them through llc.
+String output_object_path(irGen *ir_gen, isize index) {
+	String base = ir_output_base(ir_gen, index);
+	gbString path = gb_string_make_length(heap_allocator(), base.text, base.len);
+	path = gb_string_appendc(path, ".o");
+	return make_string(cast(u8 *)path, gb_string_length(path));
+}
+
+i32 run_backend_with_temp_files(irGen *ir_gen, Timings *timings, i32 optimization_level, StringArray *objects) {
+	for (isize i = 0; i < ir_gen->output_count; i++) {
+		array_add(objects, output_object_path(ir_gen, i));
+	}
+
+	timings_start_section(timings, str_lit("llvm-opt"));
+	ExecJobs opt_jobs = {0};
+	exec_jobs_init(&opt_jobs, build_context.job_count);
+	for (isize i = 0; i < ir_gen->output_count; i++) {
+		String base = ir_output_base(ir_gen, i);
+		ExecArgs opt_args = {0};
+		opt_args_init(&opt_args);
+		exec_arg(&opt_args, "%.*s.ll", LIT(base));
+		exec_arg(&opt_args, "-o");
+		exec_arg(&opt_args, "%.*s.bc", LIT(base));
+		bool started = exec_jobs_start(&opt_jobs, "llvm-opt", false, opt_args);
+		exec_args_destroy(&opt_args);
+		if (!started) {
+			break;
+		}
+	}
+	i32 exit_code = exec_jobs_wait_all(&opt_jobs);
+	exec_jobs_destroy(&opt_jobs);
+	if (exit_code != 0) {
+		return exit_code;
+	}
+
+	timings_start_section(timings, str_lit("llvm-llc"));
+	ExecJobs llc_jobs = {0};
+	exec_jobs_init(&llc_jobs, build_context.job_count);
+	for (isize i = 0; i < ir_gen->output_count; i++) {
+		String base = ir_output_base(ir_gen, i);
+		ExecArgs llc_args = {0};
+		llc_args_init(&llc_args, optimization_level);
+		exec_arg(&llc_args, "%.*s.bc", LIT(base));
+		bool started = exec_jobs_start(&llc_jobs, "llc", false, llc_args);
+		exec_args_destroy(&llc_args);
+		if (!started) {
+			break;
+		}
+	}
+	exit_code = exec_jobs_wait_all(&llc_jobs);
+	exec_jobs_destroy(&llc_jobs);
+	return exit_code;
+}
+
+// NOTE: Everything besides the IR that affects the objects made by opt and llc
+String backend_flags_string(i32 optimization_level) {
+	BuildContext *bc = &build_context;
+	gbString str = gb_string_make(heap_allocator(), "");
+	String parts[] = {bc->ODIN_VERSION, bc->opt_flags, bc->cpu_flags, bc->llc_flags, bc->profile_llc_flags};
+	for (isize i = 0; i < gb_count_of(parts); i++) {
+		str = gb_string_append_length(str, parts[i].text, parts[i].len);
+		str = gb_string_appendc(str, "|");
+	}
+	str = gb_string_appendc(str, gb_bprintf("-O%d", optimization_level));
+	return make_string(cast(u8 *)str, gb_string_length(str));
+}
+
+// NOTE: Prints each module straight into `opt | llc` so that printing overlaps with optimization
+// and only the objects are written to disk. The object of the core module comes from the cache
+// if possible, see cache.c.
+i32 run_backend_pipelined(irGen *ir_gen, Timings *timings, i32 optimization_level, StringArray *objects) {
+	bool cache_core = build_context.cache_dir.len > 0 && cache_make_dir(build_context.cache_dir);
+
+	irSplit split = {0};
+	ir_split_init(&split, &ir_gen->module, build_context.backend_jobs, cache_core);
+	ir_gen->output_count = split.count;
+	for (isize i = 0; i < split.count; i++) {
+		array_add(objects, output_object_path(ir_gen, i));
+	}
+	String core_temp_object = {0}; // NOTE: Set while the core object is being compiled into the cache
+
+	// NOTE: The opt and llc of a module must be able to run at the same time
+	ExecJobs jobs = {0};
+	exec_jobs_init(&jobs, gb_max(build_context.job_count, 2));
+	for (isize n = 0; n < split.count; n++) {
+		// NOTE: The core module is printed first so that the names of the string constants it
+		// creates do not depend on the rest of the program
+		isize i = n;
+		if (split.core_partition >= 0) {
+			i = (n == 0) ? split.core_partition : n-1;
+		}
+
+		gbString core_text = NULL;
+		if (i == split.core_partition) {
+			core_text = gb_string_make(heap_allocator(), "");
+			gbFile memory = {0};
+			cache_memory_file(&memory, &core_text);
+			ir_print_partition(ir_gen, &split, i, &memory);
+
+			String text = make_string(cast(u8 *)core_text, gb_string_length(core_text));
+			String path = cache_core_object_path(text, backend_flags_string(optimization_level));
+			objects->e[i] = path;
+			if (cache_has_object(path)) {
+				timings_add_info(timings, str_lit("core_object"), str_lit("cached"));
+				gb_string_free(core_text);
+				continue;
+			}
+			timings_add_info(timings, str_lit("core_object"), str_lit("compiled"));
+			core_temp_object = cache_temp_path(path);
+		}
+
+		int ir_pipe[2], bc_pipe[2];
+		if (!exec_pipe(ir_pipe)) {
+			jobs.exit_code = -1;
+			break;
+		}
+		if (!exec_pipe(bc_pipe)) {
+			close(ir_pipe[0]);
+			close(ir_pipe[1]);
+			jobs.exit_code = -1;
+			break;
+		}
+
+		ExecArgs opt_args = {0};
+		opt_args_init(&opt_args);
+		exec_arg(&opt_args, "-o");
+		exec_arg(&opt_args, "-");
+		bool started = exec_jobs_start_with(&jobs, "llvm-opt", false, opt_args, ir_pipe[0], bc_pipe[1]);
+		exec_args_destroy(&opt_args);
+		if (!started) {
+			close(ir_pipe[1]);
+			close(bc_pipe[0]);
+			break;
+		}
+
+		String object = core_text != NULL ? core_temp_object : objects->e[i];
+		ExecArgs llc_args = {0};
+		llc_args_init(&llc_args, optimization_level);
+		exec_arg(&llc_args, "-");
+		exec_arg(&llc_args, "-o");
+		exec_arg(&llc_args, "%.*s", LIT(object));
+		started = exec_jobs_start_with(&jobs, "llc", false, llc_args, bc_pipe[0], -1);
+		exec_args_destroy(&llc_args);
+		if (!started) {
+			close(ir_pipe[1]);
+			break;
+		}
+
+		gbFile ir_file = {0};
+		exec_pipe_file(&ir_file, ir_pipe[1]);
+		if (core_text != NULL) {
+			gb_file_write(&ir_file, core_text, gb_string_length(core_text));
+			gb_string_free(core_text);
+		} else {
+			ir_print_partition(ir_gen, &split, i, &ir_file);
+		}
+		gb_file_close(&ir_file);
+	}
+
+	timings_start_section(timings, str_lit("llvm-opt+llc"));
+	i32 exit_code = exec_jobs_wait_all(&jobs);
+	exec_jobs_destroy(&jobs);
+
+	if (core_temp_object.len > 0) {
+		if (exit_code != 0) {
+			cache_discard_object(core_temp_object);
+		} else if (!cache_commit_object(core_temp_object, objects->e[split.core_partition])) {
+			objects->e[split.core_partition] = core_temp_object;
+		}
+	}
+	if (exit_code != 0) {
+		// NOTE: llc may have written a partial object before opt failed, the core object is
+		// either in the cache or has just been discarded
+		for (isize i = 0; i < split.count; i++) {
+			if (i != split.core_partition) {
+				unlink(gb_bprintf("%.*s", LIT(objects->e[i])));
+			}
+		}
+	}
+	ir_split_destroy(&split);
+	return exit_code;
+}
+#endif
+
+// NOTE: Tokenizes every file repeatedly with and without the ASCII fast paths and checks that
+// both produce the same tokens
+int bench_tokenizer(int file_count, char **filenames) {
+	isize const ITERATIONS = 20;
+	Array(Tokenizer) initial = {0};
+	array_init(&initial, heap_allocator());
+
+	isize total_bytes = 0;
+	for (int i = 0; i < file_count; i++) {
+		Tokenizer t = {0};
+		if (init_tokenizer(&t, make_string_c(filenames[i])) != TokenizerInit_None) {
+			gb_printf_err("Unable to read %s\n", filenames[i]);
+			return 1;
+		}
+		array_add(&initial, t);
+		total_bytes += t.end - t.start;
+	}
+	if (initial.count == 0) {
+		gb_printf_err("No files to tokenize\n");
 		return 1;
 	}
 
-	Timings timings = {0};
-	timings_init(&timings, str_lit("Total Time"), 128);
-	// defer (timings_destroy(&timings));
-	init_string_buffer_memory();
-	init_scratch_memory(gb_megabytes(10));
-	init_global_error_collector();
+	// NOTE: Touch every page of the files before timing anything
+	for_array(i, initial) {
+		u8 sum = 0;
+		for (u8 *p = initial.e[i].start; p < initial.e[i].end; p += 64) {
+			sum ^= *cast(u8 volatile *)p;
+		}
+	}
 
-#if 1
+	u64 freq = time_stamp__freq();
+	for (isize mode = 0; mode < 2; mode++) {
+		tokenizer_use_fast_paths = mode == 0;
+
+		isize token_count = 0;
+		u64 start = time_stamp_time_now();
+		for (isize iteration = 0; iteration < ITERATIONS; iteration++) {
+			for_array(i, initial) {
+				Tokenizer t = initial.e[i];
+				array_init(&t.allocated_strings, heap_allocator());
+				for (;;) {
+					Token token = tokenizer_get_token(&t);
+					token_count++;
+					if (token.kind == Token_EOF || token.kind == Token_Invalid) {
+						break;
+					}
+				}
+				for_array(j, t.allocated_strings) {
+					gb_free(heap_allocator(), t.allocated_strings.e[j].text);
+				}
+				array_free(&t.allocated_strings);
+			}
+		}
+		u64 finish = time_stamp_time_now();
+
+		f64 seconds = cast(f64)(finish - start) / cast(f64)freq;
+		f64 mb = cast(f64)(total_bytes*ITERATIONS) / (1024.0*1024.0);
+		gb_printf("%s: %td files, %td bytes, %.0f tokens/s, %.2f MB/s\n",
+		          mode == 0 ? "ASCII fast paths" : "Rune by rune",
+		          initial.count, total_bytes,
+		          cast(f64)token_count / seconds, mb / seconds);
+	}
 
-	init_build_context();
+	for_array(i, initial) {
+		Tokenizer a = initial.e[i];
+		Tokenizer b = initial.e[i];
+		array_init(&a.allocated_strings, heap_allocator());
+		array_init(&b.allocated_strings, heap_allocator());
+		for (;;) {
+			tokenizer_use_fast_paths = true;
+			Token x = tokenizer_get_token(&a);
+			tokenizer_use_fast_paths = false;
+			Token y = tokenizer_get_token(&b);
+			if (x.kind != y.kind || !str_eq(x.string, y.string) || !token_pos_eq(x.pos, y.pos)) {
+				gb_printf_err("%.*s(%td:%td) Token mismatch: `%.*s` vs `%.*s` (%td:%td)\n",
+				              LIT(token_pos_file(x.pos)), token_pos_line(x.pos), token_pos_column(x.pos),
+				              LIT(x.string), LIT(y.string), token_pos_line(y.pos), token_pos_column(y.pos));
+				return 1;
+			}
+			if (x.kind == Token_EOF || x.kind == Token_Invalid) {
+				break;
+			}
+		}
+	}
+	tokenizer_use_fast_paths = true;
 
-	init_universal_scope();
+	return 0;
+}
 
+// NOTE: Runs a command other than `serve` once the compiler has been set up by `main`. The
+// children of `odin serve` (see server.c) run it too.
+int run_command(Timings *timings, int argc, char **argv) {
 	char *init_filename = NULL;
 	bool run_output = false;
 	String arg1 = make_string_c(argv[1]);
 	if (str_eq(arg1, str_lit("run"))) {
-		if (argc != 3) {
+		if (argc < 3) {
 			usage(argv[0]);
 			return 1;
 		}
 		init_filename = argv[2];
 		run_output = true;
 	} else if (str_eq(arg1, str_lit("build_dll"))) {
-		if (argc != 3) {
+		if (argc < 3) {
 			usage(argv[0]);
 			return 1;
 		}
 		init_filename = argv[2];
 		build_context.is_dll = true;
 	} else if (str_eq(arg1, str_lit("build"))) {
-		if (argc != 3) {
+		if (argc < 3) {
 			usage(argv[0]);
 			return 1;
 		}
 		init_filename = argv[2];
+	} else if (str_eq(arg1, str_lit("bench_tokenizer"))) {
+		return bench_tokenizer(argc-2, argv+2);
+#if defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+	} else if (str_eq(arg1, str_lit("bench_generate"))) {
+		return bench_generate_command(argc, argv);
+	} else if (str_eq(arg1, str_lit("bench"))) {
+		return bench_command(argc, argv);
+#endif
 	} else if (str_eq(arg1, str_lit("version"))) {
 		gb_printf("%s version %.*s\n", argv[0], LIT(build_context.ODIN_VERSION));
 		return 0;
@@ -183,9 +564,15 @@ int main(int argc, char **argv) {
 		return 1;
 	}
 
+	if (!parse_build_flags(argc, argv, 3)) {
+		usage(argv[0]);
+		return 1;
+	}
+	add_build_timings_infos(timings);
+
 	// TODO(bill): prevent compiling without a linker
 
-	timings_start_section(&timings, str_lit("parse files"));
+	timings_start_section(timings, str_lit("parse files"));
 
 	Parser parser = {0};
 	if (!init_parser(&parser)) {
@@ -196,10 +583,17 @@ int main(int argc, char **argv) {
 	if (parse_files(&parser, init_filename) != ParseFile_None) {
 		return 1;
 	}
+	timings_add_counter(timings, str_lit("tokens"), parser.total_token_count);
+	timings_add_counter(timings, str_lit("lines"),  parser.total_line_count);
+	if (parser.reused_file_count > 0) {
+		u8 *count_text = gb_alloc_array(heap_allocator(), u8, 24);
+		isize count_len = gb_snprintf(cast(char *)count_text, 24, "%td", parser.reused_file_count);
+		timings_add_info(timings, str_lit("reused_files"), make_string(count_text, count_len-1));
+	}
 
 
 #if 1
-	timings_start_section(&timings, str_lit("type check"));
+	timings_start_section(timings, str_lit("type check"));
 
 	Checker checker = {0};
 
@@ -229,86 +623,84 @@ int main(int argc, char **argv) {
 	}
 	// defer (ssa_gen_destroy(&ir_gen));
 
-	timings_start_section(&timings, str_lit("llvm ir gen"));
+	timings_start_section(timings, str_lit("llvm ir gen"));
 	ir_gen_tree(&ir_gen);
+	timings_add_counter(timings, str_lit("procedures"), ir_gen.module.procs.count);
 
-	timings_start_section(&timings, str_lit("llvm ir opt tree"));
+	timings_start_section(timings, str_lit("llvm ir opt tree"));
 	ir_opt_tree(&ir_gen);
 
-	timings_start_section(&timings, str_lit("llvm ir print"));
-	print_llvm_ir(&ir_gen);
+	timings_start_section(timings, str_lit("llvm ir print"));
+	if (build_context.keep_temps) {
+		print_llvm_ir(&ir_gen);
+	}
 
 	// prof_print_all();
 
 	#if 1
-	timings_start_section(&timings, str_lit("llvm-opt"));
-
 	String output_name = ir_gen.output_name;
 	String output_base = ir_gen.output_base;
 	int base_name_len = output_base.len;
 
-	i32 optimization_level = 0;
+	i32 optimization_level = build_context.optimization_level;
 	optimization_level = gb_clamp(optimization_level, 0, 3);
 
 	i32 exit_code = 0;
 
 	#if defined(GB_SYSTEM_WINDOWS)
-	// For more passes arguments: http://llvm.org/docs/Passes.html
-	exit_code = system_exec_command_line_app("llvm-opt", false,
-		"\"%.*sbin/opt\" \"%.*s\".ll -o \"%.*s\".bc "
-		"-mem2reg "
-		"-memcpyopt "
-		"-die "
-		// "-dse "
-		// "-dce "
-		// "-S "
-		"",
-		LIT(build_context.ODIN_ROOT),
-		LIT(output_base), LIT(output_base));
-	if (exit_code != 0) {
-		return exit_code;
+	timings_start_section(timings, str_lit("llvm-opt"));
+	for (isize i = 0; i < ir_gen.output_count; i++) {
+		String base = ir_output_base(&ir_gen, i);
+		// For more passes arguments: http://llvm.org/docs/Passes.html
+		exit_code = system_exec_command_line_app("llvm-opt", false,
+			"\"%.*sbin/opt\" \"%.*s\".ll -o \"%.*s\".bc "
+			"%.*s %.*s "
+			// "-dse "
+			// "-dce "
+			// "-S "
+			"",
+			LIT(build_context.ODIN_ROOT),
+			LIT(base), LIT(base),
+			LIT(build_context.opt_flags), LIT(build_context.cpu_flags));
+		if (exit_code != 0) {
+			return exit_code;
+		}
 	}
 	#else
-	// NOTE(zangent): This is separate because it seems that LLVM tools are packaged
-	//   with the Windows version, while they will be system-provided on MacOS and GNU/Linux
-	exit_code = system_exec_command_line_app("llvm-opt", false,
-		"opt \"%.*s\".ll -o \"%.*s\".bc "
-		"-mem2reg "
-		"-memcpyopt "
-		"-die "
-		#if defined(GB_SYSTEM_OSX)
-			// This sets a requirement of Mountain Lion and up, but the compiler doesn't work without this limit.
-			// NOTE: If you change this (although this minimum is as low as you can go with Odin working)
-			//       make sure to also change the `macosx_version_min` param passed to `llc`
-			"-mtriple=x86_64-apple-macosx10.8 "
-		#endif
-		// "-dse "
-		// "-dce "
-		// "-S "
-		"",
-		LIT(output_base), LIT(output_base));
+	StringArray objects = {0};
+	array_init(&objects, heap_allocator());
+	if (build_context.keep_temps) {
+		exit_code = run_backend_with_temp_files(&ir_gen, timings, optimization_level, &objects);
+	} else {
+		exit_code = run_backend_pipelined(&ir_gen, timings, optimization_level, &objects);
+	}
 	if (exit_code != 0) {
 		return exit_code;
 	}
 	#endif
 
 	#if defined(GB_SYSTEM_WINDOWS)
-	timings_start_section(&timings, str_lit("llvm-llc"));
-	// For more arguments: http://llvm.org/docs/CommandGuide/llc.html
-	exit_code = system_exec_command_line_app("llvm-llc", false,
-		"\"%.*sbin/llc\" \"%.*s.bc\" -filetype=obj -O%d "
-		"%.*s "
-		// "-debug-pass=Arguments "
-		"",
-		LIT(build_context.ODIN_ROOT),
-		LIT(output_base),
-		optimization_level,
-		LIT(build_context.llc_flags));
-	if (exit_code != 0) {
-		return exit_code;
+	timings_start_section(timings, str_lit("llvm-llc"));
+	for (isize i = 0; i < ir_gen.output_count; i++) {
+		String base = ir_output_base(&ir_gen, i);
+		// For more arguments: http://llvm.org/docs/CommandGuide/llc.html
+		exit_code = system_exec_command_line_app("llvm-llc", false,
+			"\"%.*sbin/llc\" \"%.*s.bc\" -filetype=obj -O%d "
+			"%.*s %.*s %.*s "
+			// "-debug-pass=Arguments "
+			"",
+			LIT(build_context.ODIN_ROOT),
+			LIT(base),
+			optimization_level,
+			LIT(build_context.cpu_flags),
+			LIT(build_context.llc_flags),
+			LIT(build_context.profile_llc_flags));
+		if (exit_code != 0) {
+			return exit_code;
+		}
 	}
 
-	timings_start_section(&timings, str_lit("msvc-link"));
+	timings_start_section(timings, str_lit("msvc-link"));
 
 	gbString lib_str = gb_string_make(heap_allocator(), "");
 	// defer (gb_string_free(lib_str));
@@ -320,6 +712,11 @@ int main(int argc, char **argv) {
 		                        " \"%.*s\"", LIT(lib));
 		lib_str = gb_string_appendc(lib_str, lib_str_buf);
 	}
+	for (isize i = 1; i < ir_gen.output_count; i++) {
+		String base = ir_output_base(&ir_gen, i);
+		gb_snprintf(lib_str_buf, gb_size_of(lib_str_buf), " \"%.*s.obj\"", LIT(base));
+		lib_str = gb_string_appendc(lib_str, lib_str_buf);
+	}
 
 	char *output_ext = "exe";
 	char *link_settings = "";
@@ -334,18 +731,18 @@ int main(int argc, char **argv) {
 		"link \"%.*s\".obj -OUT:\"%.*s.%s\" %s "
 		"/defaultlib:libcmt "
 		"/nologo /incremental:no /opt:ref /subsystem:CONSOLE "
-		" %.*s "
+		" %.*s %.*s "
 		" %s "
 		"",
 		LIT(output_base), LIT(output_base), output_ext,
-		lib_str, LIT(build_context.link_flags),
+		lib_str, LIT(build_context.link_flags), LIT(build_context.profile_link_flags),
 		link_settings
 		);
 	if (exit_code != 0) {
 		return exit_code;
 	}
 
-	// timings_print_all(&timings);
+	show_timings(timings);
 
 	if (run_output) {
 		system_exec_command_line_app("odin run", false, "%.*s.exe", LIT(output_base));
@@ -356,46 +753,7 @@ int main(int argc, char **argv) {
 	// NOTE(zangent): Linux / Unix is unfinished and not tested very well.
 
 
-	timings_start_section(&timings, str_lit("llvm-llc"));
-	// For more arguments: http://llvm.org/docs/CommandGuide/llc.html
-	exit_code = system_exec_command_line_app("llc", false,
-		"llc \"%.*s.bc\" -filetype=obj -O%d "
-		"%.*s "
-		// "-debug-pass=Arguments "
-		"",
-		LIT(output_base),
-		optimization_level,
-		LIT(build_context.llc_flags));
-	if (exit_code != 0) {
-		return exit_code;
-	}
-
-	timings_start_section(&timings, str_lit("ld-link"));
-
-	gbString lib_str = gb_string_make(heap_allocator(), "");
-	// defer (gb_string_free(lib_str));
-	char lib_str_buf[1024] = {0};
-	for_array(i, ir_gen.module.foreign_library_paths) {
-		String lib = ir_gen.module.foreign_library_paths.e[i];
-
-		// NOTE(zangent): Sometimes, you have to use -framework on MacOS.
-		//   This allows you to specify '-f' in a #foreign_system_library,
-		//   without having to implement any new syntax specifically for MacOS.
-		#if defined(GB_SYSTEM_OSX)
-			isize len;
-			if(lib.len > 2 && lib.text[0] == '-' && lib.text[1] == 'f') {
-				len = gb_snprintf(lib_str_buf, gb_size_of(lib_str_buf),
-				                        " -framework %.*s ", (int)(lib.len) - 2, lib.text + 2);
-			} else {
-				len = gb_snprintf(lib_str_buf, gb_size_of(lib_str_buf),
-				                        " -l%.*s ", LIT(lib));
-			}
-		#else
-			isize len = gb_snprintf(lib_str_buf, gb_size_of(lib_str_buf),
-			                        " -l%.*s ", LIT(lib));
-		#endif
-		lib_str = gb_string_appendc(lib_str, lib_str_buf);
-	}
+	timings_start_section(timings, str_lit("ld-link"));
 
 	// Unlike the Win32 linker code, the output_ext includes the dot, because
 	// typically executable files on *NIX systems don't have extensions.
@@ -427,41 +785,119 @@ int main(int argc, char **argv) {
 		linker = "clang -Wno-unused-command-line-argument";
 	#endif
 
-	exit_code = system_exec_command_line_app("ld-link", true,
-		"%s \"%.*s\".o -o \"%.*s%s\" %s "
-		"-lc -lm "
-		" %.*s "
-		" %s "
+	ExecArgs link_args = {0};
+	exec_args_init(&link_args);
+	exec_args_split(&link_args, make_string_c(linker));
+	for_array(i, objects) {
+		exec_arg(&link_args, "%.*s", LIT(objects.e[i]));
+	}
+	exec_arg(&link_args, "-o");
+	exec_arg(&link_args, "%.*s%s", LIT(output_base), output_ext);
+	for_array(i, ir_gen.module.foreign_library_paths) {
+		String lib = ir_gen.module.foreign_library_paths.e[i];
+
+		// NOTE(zangent): Sometimes, you have to use -framework on MacOS.
+		//   This allows you to specify '-f' in a #foreign_system_library,
+		//   without having to implement any new syntax specifically for MacOS.
 		#if defined(GB_SYSTEM_OSX)
-			// This sets a requirement of Mountain Lion and up, but the compiler doesn't work without this limit.
-			// NOTE: If you change this (although this minimum is as low as you can go with Odin working)
-			//       make sure to also change the `mtriple` param passed to `opt`
-			" -macosx_version_min 10.8.0 "
-			// This points the linker to where the entry point is
-			" -e _main "
+			if(lib.len > 2 && lib.text[0] == '-' && lib.text[1] == 'f') {
+				exec_arg(&link_args, "-framework");
+				exec_arg(&link_args, "%.*s", (int)(lib.len) - 2, lib.text + 2);
+			} else {
+				exec_arg(&link_args, "-l%.*s", LIT(lib));
+			}
+		#else
+			exec_arg(&link_args, "-l%.*s", LIT(lib));
 		#endif
-		, linker, LIT(output_base), LIT(output_base), output_ext,
-		lib_str, LIT(build_context.link_flags),
-		link_settings
-		);
+	}
+	exec_arg(&link_args, "-lc");
+	exec_arg(&link_args, "-lm");
+	exec_args_split(&link_args, build_context.link_flags);
+	exec_args_split(&link_args, build_context.profile_link_flags);
+	exec_args_split(&link_args, make_string_c(link_settings));
+	#if defined(GB_SYSTEM_OSX)
+		// This sets a requirement of Mountain Lion and up, but the compiler doesn't work without this limit.
+		// NOTE: If you change this (although this minimum is as low as you can go with Odin working)
+		//       make sure to also change the `mtriple` param passed to `opt`
+		exec_arg(&link_args, "-macosx_version_min");
+		exec_arg(&link_args, "10.8.0");
+		// This points the linker to where the entry point is
+		exec_arg(&link_args, "-e");
+		exec_arg(&link_args, "_main");
+	#endif
+
+	exit_code = exec_process("ld-link", true, link_args);
+	exec_args_destroy(&link_args);
 	if (exit_code != 0) {
 		return exit_code;
 	}
 
-	// timings_print_all(&timings);
+	show_timings(timings);
 
 	if (run_output) {
-		system_exec_command_line_app("odin run", false, "%.*s", LIT(output_base));
+		ExecArgs run_args = {0};
+		exec_args_init(&run_args);
+		exec_arg(&run_args, "%.*s", LIT(output_base));
+		exec_process_inherit(run_args);
+		exec_args_destroy(&run_args);
 	}
 
 	#endif
 #endif
-#endif
 #endif
 
 	return 0;
 }
 
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		usage(argv[0]);
+		return 1;
+	}
+
+#if defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+	{
+		i32 exit_code = 0;
+		if (server_forward_command(argc, argv, &exit_code)) {
+			return exit_code;
+		}
+	}
+#endif
+
+	// NOTE: Must be decided before the first allocation
+	for (isize i = 2; i < argc; i++) {
+		if (str_eq(make_string_c(argv[i]), str_lit("-show-memory"))) {
+			memory_tracking = true;
+		}
+	}
+
+	Timings timings = {0};
+	timings_init(&timings, str_lit("Total Time"), 128);
+	// defer (timings_destroy(&timings));
+	init_string_buffer_memory();
+	init_scratch_memory(gb_megabytes(10));
+	init_global_error_collector();
+	init_token_files();
+	init_atoms();
+	init_keyword_hash_table();
+
+	init_build_context();
+
+	init_universal_scope();
+
+#if defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+	if (str_eq(make_string_c(argv[1]), str_lit("serve"))) {
+		if (argc != 3) {
+			usage(argv[0]);
+			return 1;
+		}
+		return server_run(make_string_c(argv[2]));
+	}
+#endif
+
+	return run_command(&timings, argc, argv);
+}
+
 #if defined(__cplusplus)
 }
 #endif
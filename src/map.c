@@ -62,6 +62,10 @@ bool hash_key_equal(HashKey a, HashKey b) {
 		// NOTE(bill): If two string's hashes collide, compare the strings themselves
 		if (a.kind == HashKey_String) {
 			if (b.kind == HashKey_String) {
+				if (a.string.text == b.string.text) {
+					// NOTE: Always the case for interned strings, see atom.c
+					return a.string.len == b.string.len;
+				}
 				return str_eq(a.string, b.string);
 			}
 			return false;
@@ -102,6 +106,7 @@ void      _J2(MAP_PROC,remove)           (MAP_NAME *h, HashKey key);
 void      _J2(MAP_PROC,clear)            (MAP_NAME *h);
 void      _J2(MAP_PROC,grow)             (MAP_NAME *h);
 void      _J2(MAP_PROC,rehash)           (MAP_NAME *h, isize new_count);
+void      _J2(MAP_PROC,reserve)          (MAP_NAME *h, isize capacity);
 
 // Mutlivalued map procedure
 MAP_ENTRY *_J2(MAP_PROC,multi_find_first)(MAP_NAME *h, HashKey key);
@@ -212,6 +217,14 @@ void _J2(MAP_PROC,rehash)(MAP_NAME *h, isize new_count) {
 	*h = nh;
 }
 
+// NOTE: Makes room for `capacity` entries in total, so that adding them rehashes at most once
+void _J2(MAP_PROC,reserve)(MAP_NAME *h, isize capacity) {
+	if (0.75f * h->hashes.count <= capacity) {
+		_J2(MAP_PROC,rehash)(h, ARRAY_GROW_FORMULA(capacity));
+	}
+	array_reserve(&h->entries, capacity);
+}
+
 gb_inline MAP_TYPE *_J2(MAP_PROC,get)(MAP_NAME *h, HashKey key) {
 	isize index = _J2(MAP_PROC,_find)(h, key).entry_index;
 	if (index >= 0) {
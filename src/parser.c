@@ -17,15 +17,29 @@ typedef enum ParseFileError {
 
 typedef Array(AstNode *) AstNodeArray;
 
+// NOTE: Lookahead available to the parser when tokens are streamed, must be a power of two
+#define AST_FILE_TOKEN_RING_SIZE 8
+
 typedef struct AstFile {
 	i32            id;
 	gbArena        arena;
+	gbVirtualMemory arena_vm;  // NOTE: Backs `arena`, only the pages that are used are touched
 	Tokenizer      tokenizer;
-	Array(Token)   tokens;
+	Array(Token)   tokens;     // NOTE: Only used if !stream_tokens
 	isize          curr_token_index;
 	Token          curr_token;
 	Token          prev_token; // previous non-comment
 
+	// NOTE: When streaming, the parser pulls non-comment tokens from the tokenizer on demand
+	// and only the last AST_FILE_TOKEN_RING_SIZE of them are kept
+	bool           stream_tokens;
+	Token          token_ring[AST_FILE_TOKEN_RING_SIZE];
+	isize          token_ring_end; // NOTE: Index one past the last streamed token
+	isize          token_count;    // NOTE: Tokens read from the tokenizer, including comments
+	Token          first_token;    // NOTE: May be a comment
+	u32            node_count;     // NOTE: The index of the next node (see AstNode.index)
+	bool           invalid_token;
+
 	// >= 0: In Expression
 	// <  0: In Control Clause
 	// NOTE(bill): Used to prevent type literals in control clauses
@@ -35,6 +49,8 @@ typedef struct AstFile {
 	AstNodeArray   decls;
 	bool           is_global_scope;
 
+	Array(AstNodeArray) array_builders; // NOTE: Reused by make_ast_node_array, freed once the file is parsed
+
 	AstNode *      curr_proc;
 	isize          scope_level;
 	Scope *        scope;       // NOTE(bill): Created in checker
@@ -59,9 +75,26 @@ typedef struct Parser {
 	gbAtomic32          import_index;
 	isize               total_token_count;
 	isize               total_line_count;
+	isize               reused_file_count; // NOTE: Files taken from `preparsed_files`
 	gbMutex             mutex;
+
+	// NOTE: Only used when parsing with worker threads
+	bool                use_workers;
+	gbSemaphore         work_semaphore;
+	isize               pending_imports;
+	bool                workers_done;
+	ParseFileError      worker_error;
 } Parser;
 
+// NOTE: Files parsed ahead of time by `odin serve` (see server.c), which forks a child for each
+// build. The child takes these files from here instead of parsing them again.
+typedef struct PreparsedFiles {
+	Array(AstFile) files;
+	MapIsize       index; // Key: String (fullpath); Value: index into `files`
+} PreparsedFiles;
+
+gb_global PreparsedFiles preparsed_files = {0};
+
 typedef enum ProcTag {
 	ProcTag_bounds_check    = 1<<0,
 	ProcTag_no_bounds_check = 1<<1,
@@ -114,10 +147,43 @@ typedef enum StmtAllowFlag {
 
 
 
+// NOTE: AST arrays live in the file's arena. As their size is rarely known up front, they are built
+// in a scratch array from make_ast_node_array and copied into the arena by end_ast_node_array,
+// which also returns the scratch array to the file's pool for the next list.
 AstNodeArray make_ast_node_array(AstFile *f) {
 	AstNodeArray a;
-	// array_init(&a, gb_arena_allocator(&f->arena));
-	array_init(&a, heap_allocator());
+	if (f->array_builders.count > 0) {
+		a = f->array_builders.e[--f->array_builders.count];
+	} else {
+		array_init(&a, tagged_allocator(MemoryTag_Ast));
+	}
+	return a;
+}
+
+// NOTE: The array is zeroed and has a slot even if `count` is 0, as some code reads e[0] regardless
+AstNodeArray make_ast_node_array_count(AstFile *f, isize count) {
+	gbArena *arena = &f->arena;
+	isize size = gb_size_of(AstNode *)*gb_max(count, 1);
+	if (gb_arena_size_remaining(arena, GB_DEFAULT_MEMORY_ALIGNMENT) <= size + GB_DEFAULT_MEMORY_ALIGNMENT) {
+		// NOTE: Like make_ast_node, just quit
+		gb_exit(1);
+	}
+	AstNodeArray a = {0};
+	a.allocator = gb_arena_allocator(arena);
+	a.e         = cast(AstNode **)gb_alloc(a.allocator, size);
+	a.count     = count;
+	a.capacity  = gb_max(count, 1);
+	return a;
+}
+
+AstNodeArray end_ast_node_array(AstFile *f, AstNodeArray builder) {
+	AstNodeArray a = make_ast_node_array_count(f, builder.count);
+	gb_memmove(a.e, builder.e, gb_size_of(AstNode *)*builder.count);
+	array_clear(&builder);
+	if (f->array_builders.e == NULL) {
+		array_init(&f->array_builders, tagged_allocator(MemoryTag_Ast));
+	}
+	array_add(&f->array_builders, builder);
 	return a;
 }
 
@@ -427,6 +493,8 @@ String const ast_node_strings[] = {
 typedef struct AstNode {
 	AstNodeKind kind;
 	u32 stmt_state_flags;
+	u32 file_id; // NOTE: Id of the file in `token_files`, 0 if the node was not made by the parser
+	u32 index;   // NOTE: Dense within the file, the checker records what it finds in tables indexed by it
 	union {
 #define AST_NODE_KIND(_kind_name_, name, ...) GB_JOIN2(AstNode, _kind_name_) _kind_name_;
 	AST_NODE_KINDS
@@ -434,6 +502,17 @@ typedef struct AstNode {
 	};
 } AstNode;
 
+// NOTE: Nodes allocated by the parser only have room for the header and the payload of their kind
+// (see make_ast_node), so an AstNode must never be copied or assigned as a whole. Code that needs
+// a node of any kind, such as the checker's temporary nodes, allocates a full AstNode instead
+// (see alloc_ast_node).
+gb_global isize const ast_node_sizes[AstNode_Count] = {
+	gb_offset_of(AstNode, Ident), // NOTE: AstNode_Invalid has no payload
+#define AST_NODE_KIND(_kind_name_, ...) gb_offset_of(AstNode, _kind_name_) + gb_size_of(GB_JOIN2(AstNode, _kind_name_)),
+	AST_NODE_KINDS
+#undef AST_NODE_KIND
+};
+
 
 #define ast_node(n_, Kind_, node_) GB_JOIN2(AstNode, Kind_) *n_ = &(node_)->Kind_; GB_ASSERT((node_)->kind == GB_JOIN2(AstNode_, Kind_))
 #define case_ast_node(n_, Kind_, node_) case GB_JOIN2(AstNode_, Kind_): { ast_node(n_, Kind_, node_);
@@ -569,8 +648,11 @@ AstNode *clone_ast_node(gbAllocator a, AstNode *node) {
 	if (node == NULL) {
 		return NULL;
 	}
-	AstNode *n = gb_alloc_item(a, AstNode);
-	gb_memmove(n, node, gb_size_of(AstNode));
+	isize size = ast_node_sizes[node->kind];
+	AstNode *n = cast(AstNode *)gb_alloc_align(a, size, gb_align_of(AstNode));
+	gb_memmove(n, node, size);
+	n->file_id = 0; // NOTE: Nothing is recorded for a clone
+	n->index   = 0;
 
 	switch (n->kind) {
 	case AstNode_Ident: break;
@@ -849,11 +931,23 @@ bool ast_node_expect(AstNode *node, AstNodeKind kind) {
 // NOTE(bill): And this below is why is I/we need a new language! Discriminated unions are a pain in C/C++
 AstNode *make_ast_node(AstFile *f, AstNodeKind kind) {
 	gbArena *arena = &f->arena;
-	if (gb_arena_size_remaining(arena, GB_DEFAULT_MEMORY_ALIGNMENT) <= gb_size_of(AstNode)) {
+	isize size = ast_node_sizes[kind];
+	if (gb_arena_size_remaining(arena, gb_align_of(AstNode)) <= size + gb_align_of(AstNode)) {
 		// NOTE(bill): If a syntax error is so bad, just quit!
 		gb_exit(1);
 	}
-	AstNode *node = gb_alloc_item(gb_arena_allocator(arena), AstNode);
+	AstNode *node = cast(AstNode *)gb_alloc_align(gb_arena_allocator(arena), size, gb_align_of(AstNode));
+	node->kind    = kind;
+	node->file_id = f->tokenizer.file_id;
+	node->index   = f->node_count++;
+	return node;
+}
+
+// NOTE: For the temporary nodes of the checker and the IR, which have no id and so nothing is
+// recorded for them
+AstNode *alloc_ast_node(gbAllocator a, AstNodeKind kind) {
+	AstNode *node = gb_alloc_item(a, AstNode);
+	gb_zero_item(node);
 	node->kind = kind;
 	return node;
 }
@@ -1432,15 +1526,50 @@ AstNode *ast_label_decl(AstFile *f, Token token, AstNode *name) {
 }
 
 
+Token stream_next_token(AstFile *f) {
+	if (f->token_ring_end > 0) {
+		Token last = f->token_ring[(f->token_ring_end-1) & (AST_FILE_TOKEN_RING_SIZE-1)];
+		if (last.kind == Token_EOF) {
+			return last;
+		}
+	}
+	for (;;) {
+		Token token = tokenizer_get_token(&f->tokenizer);
+		if (f->token_count++ == 0) {
+			f->first_token = token;
+		}
+		if (token.kind == Token_Invalid) {
+			// NOTE: The parser reports the token and the file is rejected once parsed
+			f->invalid_token = true;
+		}
+		if (token.kind != Token_Comment) {
+			return token;
+		}
+	}
+}
+
+Token token_at(AstFile *f, isize index) {
+	if (!f->stream_tokens) {
+		return f->tokens.e[index];
+	}
+	GB_ASSERT_MSG(index >= f->token_ring_end - AST_FILE_TOKEN_RING_SIZE,
+	              "Token %td is no longer in the ring buffer", index);
+	while (index >= f->token_ring_end) {
+		f->token_ring[f->token_ring_end & (AST_FILE_TOKEN_RING_SIZE-1)] = stream_next_token(f);
+		f->token_ring_end++;
+	}
+	return f->token_ring[index & (AST_FILE_TOKEN_RING_SIZE-1)];
+}
+
 bool next_token(AstFile *f) {
 	Token prev = f->curr_token;
-	if (f->curr_token_index+1 < f->tokens.count) {
+	if (f->curr_token.kind != Token_EOF) {
 		if (f->curr_token.kind != Token_Comment) {
 			f->prev_token = f->curr_token;
 		}
 
 		f->curr_token_index++;
-		f->curr_token = f->tokens.e[f->curr_token_index];
+		f->curr_token = token_at(f, f->curr_token_index);
 		if (f->curr_token.kind == Token_Comment) {
 			return next_token(f);
 		}
@@ -1457,7 +1586,7 @@ TokenKind look_ahead_token_kind(AstFile *f, isize amount) {
 	isize index = f->curr_token_index;
 	while (amount > 0) {
 		index++;
-		kind = f->tokens.e[index].kind;
+		kind = token_at(f, index).kind;
 		if (kind != Token_Comment) {
 			amount--;
 		}
@@ -1651,7 +1780,7 @@ void expect_semicolon(AstFile *f, AstNode *s) {
 	}
 
 	if (s != NULL) {
-		if (prev_token.pos.line != f->curr_token.pos.line) {
+		if (token_pos_newline_between(prev_token.pos, f->curr_token.pos)) {
 			if (is_semicolon_optional_for_node(f, s)) {
 				return;
 			}
@@ -1687,7 +1816,7 @@ AstNode *parse_ident(AstFile *f) {
 	if (token.kind == Token_Ident) {
 		next_token(f);
 	} else {
-		token.string = str_lit("_");
+		token_set_string(&token, str_lit("_"));
 		expect_token(f, Token_Ident);
 	}
 	return ast_ident(f, token);
@@ -1732,7 +1861,7 @@ AstNodeArray parse_element_list(AstFile *f) {
 		}
 	}
 
-	return elems;
+	return end_ast_node_array(f, elems);
 }
 
 AstNode *parse_literal_value(AstFile *f, AstNode *type) {
@@ -1943,7 +2072,7 @@ AstNode *convert_stmt_to_expr(AstFile *f, AstNode *statement, String kind) {
 	}
 
 	syntax_error(f->curr_token, "Expected `%.*s`, found a simple statement.", LIT(kind));
-	return ast_bad_expr(f, f->curr_token, f->tokens.e[f->curr_token_index+1]);
+	return ast_bad_expr(f, f->curr_token, token_at(f, f->curr_token_index+1));
 }
 
 
@@ -1985,7 +2114,7 @@ AstNode *parse_operand(AstFile *f, bool lhs) {
 				next_token(f);
 			}
 
-			token.string = make_string(data.e, data.count);
+			token_set_string(&token, make_string(data.e, data.count));
 			array_add(&f->tokenizer.allocated_strings, token.string);
 		}
 
@@ -2064,7 +2193,7 @@ AstNode *parse_operand(AstFile *f, bool lhs) {
 			// TODO(bill): Is this correct???
 			// NOTE(bill): Sanity check as identifiers should be handled already
 			TokenPos pos = ast_node_token(type).pos;
-			GB_ASSERT_MSG(type->kind != AstNode_Ident, "Type cannot be identifier %.*s(%td:%td)", LIT(pos.file), pos.line, pos.column);
+			GB_ASSERT_MSG(type->kind != AstNode_Ident, "Type cannot be identifier %.*s(%td:%td)", LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
 			return type;
 		}
 		break;
@@ -2100,7 +2229,7 @@ AstNode *parse_call_expr(AstFile *f, AstNode *operand) {
 
 	while (f->curr_token.kind != Token_CloseParen &&
 	       f->curr_token.kind != Token_EOF &&
-	       ellipsis.pos.line == 0) {
+	       ellipsis.pos.file_id == 0) {
 		if (f->curr_token.kind == Token_Comma) {
 			syntax_error(f->curr_token, "Expected an expression not a ,");
 		}
@@ -2121,7 +2250,7 @@ AstNode *parse_call_expr(AstFile *f, AstNode *operand) {
 	f->expr_level--;
 	close_paren = expect_closing(f, Token_CloseParen, str_lit("argument list"));
 
-	return ast_call_expr(f, operand, args, open_paren, close_paren, ellipsis);
+	return ast_call_expr(f, operand, end_ast_node_array(f, args), open_paren, close_paren, ellipsis);
 }
 
 
@@ -2151,7 +2280,7 @@ AstNode *parse_macro_call_expr(AstFile *f, AstNode *operand) {
 	f->expr_level--;
 	close_paren = expect_closing(f, Token_CloseParen, str_lit("argument list"));
 
-	return ast_macro_call_expr(f, operand, bang, args, open_paren, close_paren);
+	return ast_macro_call_expr(f, operand, bang, end_ast_node_array(f, args), open_paren, close_paren);
 }
 
 AstNode *parse_atom_expr(AstFile *f, bool lhs) {
@@ -2405,7 +2534,7 @@ AstNodeArray parse_expr_list(AstFile *f, bool lhs) {
 		next_token(f);
 	}
 
-	return list;
+	return end_ast_node_array(f, list);
 }
 
 AstNodeArray parse_lhs_expr_list(AstFile *f) {
@@ -2428,7 +2557,7 @@ AstNodeArray parse_ident_list(AstFile *f) {
 		next_token(f);
 	} while (true);
 
-	return list;
+	return end_ast_node_array(f, list);
 }
 
 
@@ -2495,11 +2624,9 @@ AstNode *parse_value_decl(AstFile *f, AstNodeArray lhs) {
 	}
 
 	if (values.e == NULL) {
-		values = make_ast_node_array(f);
+		values = make_ast_node_array_count(f, 0);
 	}
 
-	AstNodeArray specs = {0};
-	array_init_reserve(&specs, heap_allocator(), 1);
 	return ast_value_decl(f, is_mutable, lhs, type, values);
 }
 
@@ -2546,8 +2673,7 @@ AstNode *parse_simple_stmt(AstFile *f, StmtAllowFlag flags) {
 			AstNode *expr = parse_expr(f, false);
 			f->allow_range = prev_allow_range;
 
-			AstNodeArray rhs = {0};
-			array_init_count(&rhs, heap_allocator(), 1);
+			AstNodeArray rhs = make_ast_node_array_count(f, 1);
 			rhs.e[0] = expr;
 
 			return ast_assign_stmt(f, token, lhs, rhs);
@@ -2621,9 +2747,9 @@ AstNode *parse_results(AstFile *f) {
 	if (f->curr_token.kind != Token_OpenParen) {
 		Token begin_token = f->curr_token;
 		AstNodeArray empty_names = {0};
-		AstNodeArray list = make_ast_node_array(f);
+		AstNodeArray list = make_ast_node_array_count(f, 1);
 		AstNode *type = parse_type(f);
-		array_add(&list, ast_field(f, empty_names, type, 0));
+		list.e[0] = ast_field(f, empty_names, type, 0);
 		return ast_field_list(f, begin_token, list);
 	}
 
@@ -2771,8 +2897,7 @@ typedef struct AstNodeAndFlags {
 typedef Array(AstNodeAndFlags) AstNodeAndFlagsArray;
 
 AstNodeArray convert_to_ident_list(AstFile *f, AstNodeAndFlagsArray list, bool ignore_flags) {
-	AstNodeArray idents = {0};
-	array_init_reserve(&idents, heap_allocator(), list.count);
+	AstNodeArray idents = make_ast_node_array_count(f, list.count);
 	// Convert to ident list
 	for_array(i, list) {
 		AstNode *ident = list.e[i].node;
@@ -2792,7 +2917,7 @@ AstNodeArray convert_to_ident_list(AstFile *f, AstNodeAndFlagsArray list, bool i
 			ident = ast_ident(f, blank_token);
 			break;
 		}
-		array_add(&idents, ident);
+		idents.e[i] = ident;
 	}
 	return idents;
 }
@@ -2816,7 +2941,7 @@ AstNode *parse_field_list(AstFile *f, isize *name_count_, u32 allowed_flags, Tok
 	Token start_token = f->curr_token;
 
 	AstNodeArray params = make_ast_node_array(f);
-	AstNodeAndFlagsArray list = {0}; array_init(&list, heap_allocator()); // LEAK(bill):
+	AstNodeAndFlagsArray list = {0}; array_init(&list, tagged_allocator(MemoryTag_Ast));
 	isize total_name_count = 0;
 	bool allow_ellipsis = allowed_flags&FieldFlag_ellipsis;
 
@@ -2873,16 +2998,16 @@ AstNode *parse_field_list(AstFile *f, isize *name_count_, u32 allowed_flags, Tok
 			}
 		}
 
+		array_free(&list);
 		if (name_count_) *name_count_ = total_name_count;
-		return ast_field_list(f, start_token, params);
+		return ast_field_list(f, start_token, end_ast_node_array(f, params));
 	}
 
 	for_array(i, list) {
-		AstNodeArray names = {0};
+		AstNodeArray names = make_ast_node_array_count(f, 1);
 		AstNode *type = list.e[i].node;
 		Token token = blank_token;
 
-		array_init_count(&names, heap_allocator(), 1);
 		token.pos = ast_node_token(type).pos;
 		names.e[0] = ast_ident(f, token);
 		u32 flags = check_field_prefixes(f, list.count, allowed_flags, list.e[i].flags);
@@ -2891,8 +3016,9 @@ AstNode *parse_field_list(AstFile *f, isize *name_count_, u32 allowed_flags, Tok
 		array_add(&params, param);
 	}
 
+	array_free(&list);
 	if (name_count_) *name_count_ = total_name_count;
-	return ast_field_list(f, start_token, params);
+	return ast_field_list(f, start_token, end_ast_node_array(f, params));
 }
 
 
@@ -3095,7 +3221,8 @@ AstNode *parse_type_or_ident(AstFile *f) {
 		Token close = expect_token(f, Token_CloseBrace);
 
 
-		return ast_union_type(f, token, decls, total_decl_name_count, variants);
+		return ast_union_type(f, token, end_ast_node_array(f, decls), total_decl_name_count,
+		                      end_ast_node_array(f, variants));
 	}
 
 	case Token_raw_union: {
@@ -3210,7 +3337,7 @@ AstNode *parse_if_stmt(AstFile *f) {
 			break;
 		default:
 			syntax_error(f->curr_token, "Expected if statement block statement");
-			else_stmt = ast_bad_stmt(f, f->curr_token, f->tokens.e[f->curr_token_index+1]);
+			else_stmt = ast_bad_stmt(f, f->curr_token, token_at(f, f->curr_token_index+1));
 			break;
 		}
 	}
@@ -3247,7 +3374,7 @@ AstNode *parse_when_stmt(AstFile *f) {
 			break;
 		default:
 			syntax_error(f->curr_token, "Expected when statement block statement");
-			else_stmt = ast_bad_stmt(f, f->curr_token, f->tokens.e[f->curr_token_index+1]);
+			else_stmt = ast_bad_stmt(f, f->curr_token, token_at(f, f->curr_token_index+1));
 			break;
 		}
 	}
@@ -3271,7 +3398,7 @@ AstNode *parse_return_stmt(AstFile *f) {
 	if (f->curr_token.kind != Token_Semicolon && f->curr_token.kind != Token_CloseBrace) {
 		results = parse_rhs_expr_list(f);
 	} else {
-		results = make_ast_node_array(f);
+		results = make_ast_node_array_count(f, 0);
 	}
 
 	expect_semicolon(f, results.e[0]);
@@ -3375,7 +3502,7 @@ AstNode *parse_for_stmt(AstFile *f) {
 
 AstNode *parse_case_clause(AstFile *f, bool is_type) {
 	Token token = f->curr_token;
-	AstNodeArray list = make_ast_node_array(f);
+	AstNodeArray list = make_ast_node_array_count(f, 0);
 	expect_token(f, Token_case);
 	bool prev_allow_range = f->allow_range;
 	f->allow_range = !is_type;
@@ -3430,7 +3557,7 @@ AstNode *parse_match_stmt(AstFile *f) {
 
 	close = expect_token(f, Token_CloseBrace);
 
-	body = ast_block_stmt(f, list, open, close);
+	body = ast_block_stmt(f, end_ast_node_array(f, list), open, close);
 
 	if (!is_type_match) {
 		tag = convert_stmt_to_expr(f, tag, str_lit("match expression"));
@@ -3665,7 +3792,7 @@ AstNode *parse_stmt(AstFile *f) {
 			AstNode *cond = NULL;
 			Token file_path = expect_token_after(f, Token_String, "#load");
 			Token import_name = file_path;
-			import_name.string = str_lit(".");
+			token_set_string(&import_name, str_lit("."));
 
 			if (allow_token(f, Token_when)) {
 				cond = parse_expr(f, false);
@@ -3831,7 +3958,7 @@ AstNodeArray parse_stmt_list(AstFile *f) {
 		}
 	}
 
-	return list;
+	return end_ast_node_array(f, list);
 }
 
 
@@ -3842,8 +3969,14 @@ ParseFileError init_ast_file(AstFile *f, String fullpath) {
 	}
 	TokenizerInitError err = init_tokenizer(&f->tokenizer, fullpath);
 	if (err == TokenizerInit_None) {
-		array_init(&f->tokens, heap_allocator());
-		{
+		isize max_token_count = 0;
+		f->stream_tokens = build_context.stream_tokens;
+		if (f->stream_tokens) {
+			// NOTE: The token count is not known up front but every token other than EOF takes at
+			// least one byte. Pages of the arena are only touched as nodes are allocated.
+			max_token_count = (f->tokenizer.end - f->tokenizer.start) + 1;
+		} else {
+			array_init(&f->tokens, tagged_allocator(MemoryTag_Tokenizer));
 			for (;;) {
 				Token token = tokenizer_get_token(&f->tokenizer);
 				if (token.kind == Token_Invalid) {
@@ -3855,16 +3988,22 @@ ParseFileError init_ast_file(AstFile *f, String fullpath) {
 					break;
 				}
 			}
+			f->token_count = f->tokens.count;
+			f->first_token = f->tokens.e[0];
+			max_token_count = f->tokens.count;
 		}
 
 		f->curr_token_index = 0;
-		f->prev_token = f->tokens.e[f->curr_token_index];
-		f->curr_token = f->tokens.e[f->curr_token_index];
+		f->prev_token = token_at(f, f->curr_token_index);
+		f->curr_token = token_at(f, f->curr_token_index);
 
 		// NOTE(bill): Is this big enough or too small?
+		// NOTE: Mapped rather than allocated, as nodes are mostly smaller than an AstNode and only
+		// the pages they are placed in are committed (except on Windows, see vm_alloc_or_exit)
 		isize arena_size = gb_size_of(AstNode);
-		arena_size *= 2*f->tokens.count;
-		gb_arena_init_from_allocator(&f->arena, heap_allocator(), arena_size);
+		arena_size *= 2*max_token_count;
+		f->arena_vm = vm_alloc_or_exit(arena_size);
+		gb_arena_init_from_memory(&f->arena, f->arena_vm.data, f->arena_vm.size);
 
 		f->curr_proc = NULL;
 
@@ -3884,8 +4023,11 @@ ParseFileError init_ast_file(AstFile *f, String fullpath) {
 }
 
 void destroy_ast_file(AstFile *f) {
-	gb_arena_free(&f->arena);
-	array_free(&f->tokens);
+	memory_tag_add(MemoryTag_Ast, -f->arena.total_allocated);
+	gb_vm_free(f->arena_vm);
+	if (!f->stream_tokens) {
+		array_free(&f->tokens);
+	}
 	gb_free(heap_allocator(), f->tokenizer.fullpath.text);
 	destroy_tokenizer(&f->tokenizer);
 }
@@ -3914,14 +4056,15 @@ void destroy_parser(Parser *p) {
 
 // NOTE(bill): Returns true if it's added
 bool try_add_import_path(Parser *p, String path, String rel_path, TokenPos pos) {
-	gb_mutex_lock(&p->mutex);
-
 	path = string_trim_whitespace(path);
 	rel_path = string_trim_whitespace(rel_path);
 
+	gb_mutex_lock(&p->mutex);
+
 	for_array(i, p->imports) {
 		String import = p->imports.e[i].path;
 		if (str_eq(import, path)) {
+			gb_mutex_unlock(&p->mutex);
 			return false;
 		}
 	}
@@ -3932,6 +4075,12 @@ bool try_add_import_path(Parser *p, String path, String rel_path, TokenPos pos)
 	item.pos = pos;
 	array_add(&p->imports, item);
 
+	if (p->use_workers) {
+		// NOTE: Hand the new file to an idle worker
+		p->pending_imports++;
+		gb_semaphore_release(&p->work_semaphore);
+	}
+
 	gb_mutex_unlock(&p->mutex);
 
 	return true;
@@ -4087,8 +4236,7 @@ void parse_setup_file_decls(Parser *p, AstFile *f, String base_dir, AstNodeArray
 	}
 }
 
-void parse_file(Parser *p, AstFile *f) {
-	String filepath = f->tokenizer.fullpath;
+String parse_file_base_dir(String filepath) {
 	String base_dir = filepath;
 	for (isize i = filepath.len-1; i >= 0; i--) {
 		if (base_dir.text[i] == '\\' ||
@@ -4097,16 +4245,235 @@ void parse_file(Parser *p, AstFile *f) {
 		}
 		base_dir.len--;
 	}
+	return base_dir;
+}
+
+ParseFileError parse_file(Parser *p, AstFile *f) {
+	String base_dir = parse_file_base_dir(f->tokenizer.fullpath);
 
 	while (f->curr_token.kind == Token_Comment) {
 		next_token(f);
 	}
 
 	f->decls = parse_stmt_list(f);
+	for_array(i, f->array_builders) {
+		array_free(&f->array_builders.e[i]);
+	}
+	array_free(&f->array_builders);
+	gb_zero_item(&f->array_builders);
+	memory_tag_add(MemoryTag_Ast, f->arena.total_allocated);
+	if (f->invalid_token) {
+		return ParseFile_InvalidToken;
+	}
 	parse_setup_file_decls(p, f, base_dir, f->decls);
+	return ParseFile_None;
+}
+
+
+
+// NOTE: Prints the reason `imported_file` could not be parsed
+void parse_print_import_error(Parser *p, ImportedFile imported_file, ParseFileError err) {
+	TokenPos pos = imported_file.pos;
+
+	gb_mutex_lock(&global_error_collector.mutex);
+	if (pos.file_id != 0) {
+		gb_printf_err("%.*s(%td:%td) ", LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos));
+	}
+	gb_printf_err("Failed to parse file: %.*s\n\t", LIT(imported_file.rel_path));
+	switch (err) {
+	case ParseFile_WrongExtension:
+		gb_printf_err("Invalid file extension: File must have the extension `.odin`");
+		break;
+	case ParseFile_InvalidFile:
+		gb_printf_err("Invalid file or cannot be found");
+		break;
+	case ParseFile_Permission:
+		gb_printf_err("File permissions problem");
+		break;
+	case ParseFile_NotFound:
+		gb_printf_err("File cannot be found (`%.*s`)", LIT(imported_file.path));
+		break;
+	case ParseFile_InvalidToken:
+		gb_printf_err("Invalid token found in file");
+		break;
+	}
+	gb_printf_err("\n");
+	gb_mutex_unlock(&global_error_collector.mutex);
+}
+
+ParseFileError parse_imported_file(Parser *p, ImportedFile imported_file, AstFile *file) {
+	if (preparsed_files.files.count > 0) {
+		isize *found = map_isize_get(&preparsed_files.index, hash_string(imported_file.path));
+		if (found != NULL) {
+			// NOTE: Only the imports need to be found again, the decls are already checked
+			*file = preparsed_files.files.e[*found];
+			parse_setup_file_decls(p, file, parse_file_base_dir(file->tokenizer.fullpath), file->decls);
+			gb_mutex_lock(&p->mutex);
+			p->reused_file_count++;
+			gb_mutex_unlock(&p->mutex);
+			return ParseFile_None;
+		}
+	}
+
+	ParseFileError err = init_ast_file(file, imported_file.path);
+	if (err != ParseFile_None) {
+		if (err == ParseFile_EmptyFile) {
+			if (str_eq(imported_file.path, p->init_fullpath)) {
+				gb_printf_err("Initial file is empty - %.*s\n", LIT(p->init_fullpath));
+				gb_exit(1);
+			}
+			return err;
+		}
+		parse_print_import_error(p, imported_file, err);
+		return err;
+	}
+	err = parse_file(p, file);
+	if (err != ParseFile_None) {
+		parse_print_import_error(p, imported_file, err);
+	}
+	return err;
+}
+
+GB_THREAD_PROC(parse_worker_proc) {
+	Parser *p = cast(Parser *)data;
+
+	for (;;) {
+		gb_semaphore_wait(&p->work_semaphore);
+
+		gb_mutex_lock(&p->mutex);
+		if (p->workers_done) {
+			gb_mutex_unlock(&p->mutex);
+			break;
+		}
+		// NOTE: Every release of the semaphore corresponds to exactly one unclaimed import
+		i32 index = gb_atomic32_fetch_add(&p->import_index, 1);
+		GB_ASSERT(index < p->imports.count);
+		ImportedFile imported_file = p->imports.e[index];
+		gb_mutex_unlock(&p->mutex);
+
+		AstFile file = {0};
+		ParseFileError err = parse_imported_file(p, imported_file, &file);
+
+		gb_mutex_lock(&p->mutex);
+		if (err == ParseFile_None) {
+			array_add(&p->files, file);
+		} else if (err != ParseFile_EmptyFile && p->worker_error == ParseFile_None) {
+			p->worker_error = err;
+		}
+		p->pending_imports--;
+		if (!p->workers_done && (p->pending_imports == 0 || p->worker_error != ParseFile_None)) {
+			p->workers_done = true;
+			gb_semaphore_post(&p->work_semaphore, cast(i32)build_context.thread_count);
+		}
+		gb_mutex_unlock(&p->mutex);
+	}
+}
+
+// NOTE: Workers finish files in whatever order they like, so put the files back into the order the
+// single threaded parser would have discovered them in. File ids (and thus mangled names) depend on it.
+void parse_sort_files_by_import_order(Parser *p, isize initial_import_count) {
+	MapIsize file_map = {0}; // Key: String (fullpath); Value: index into `p->files`
+	MapBool  seen     = {0}; // Key: String (fullpath)
+	map_isize_init(&file_map, heap_allocator());
+	map_bool_init(&seen, heap_allocator());
+
+	for_array(i, p->files) {
+		map_isize_set(&file_map, hash_string(p->files.e[i].tokenizer.fullpath), i);
+	}
+
+	Array(ImportedFile) imports = {0};
+	Array(AstFile)      files   = {0};
+	array_init_reserve(&imports, heap_allocator(), p->imports.count);
+	array_init_reserve(&files,   heap_allocator(), p->files.count);
+
+	for (isize i = 0; i < initial_import_count; i++) {
+		array_add(&imports, p->imports.e[i]);
+		map_bool_set(&seen, hash_string(p->imports.e[i].path), true);
+	}
+
+	for_array(i, imports) {
+		isize *found = map_isize_get(&file_map, hash_string(imports.e[i].path));
+		if (found == NULL) {
+			continue;
+		}
+		AstFile file = p->files.e[*found];
+		file.id = files.count;
+		array_add(&files, file);
+
+		for_array(j, file.decls) {
+			AstNode *node = file.decls.e[j];
+			if (node->kind != AstNode_ImportDecl) {
+				continue;
+			}
+			ast_node(id, ImportDecl, node);
+			String path = string_trim_whitespace(id->fullpath);
+			HashKey key = hash_string(path);
+			if (map_bool_get(&seen, key) != NULL) {
+				continue;
+			}
+			map_bool_set(&seen, key, true);
+
+			ImportedFile item = {0};
+			item.path     = path;
+			item.rel_path = string_trim_whitespace(id->relpath.string);
+			item.pos      = ast_node_token(node).pos;
+			array_add(&imports, item);
+		}
+	}
+	GB_ASSERT(files.count == p->files.count);
+
+	array_clear(&p->imports);
+	array_clear(&p->files);
+	for_array(i, imports) {
+		array_add(&p->imports, imports.e[i]);
+	}
+	for_array(i, files) {
+		array_add(&p->files, files.e[i]);
+	}
+
+	array_free(&files);
+	array_free(&imports);
+
+	map_bool_destroy(&seen);
+	map_isize_destroy(&file_map);
 }
 
+ParseFileError parse_files_with_workers(Parser *p) {
+	isize thread_count = build_context.thread_count;
+	isize initial_import_count = p->imports.count;
+	gbThread *threads = gb_alloc_array(heap_allocator(), gbThread, thread_count);
+
+	gb_semaphore_init(&p->work_semaphore);
+	p->use_workers     = true;
+	p->workers_done    = false;
+	p->worker_error    = ParseFile_None;
+	p->pending_imports = initial_import_count;
+	gb_atomic32_store(&p->import_index, 0);
+	gb_semaphore_post(&p->work_semaphore, cast(i32)initial_import_count);
+
+	for (isize i = 0; i < thread_count; i++) {
+		gb_thread_init(&threads[i]);
+		gb_thread_start(&threads[i], parse_worker_proc, p);
+	}
+	for (isize i = 0; i < thread_count; i++) {
+		gb_thread_join(&threads[i]);
+		gb_thread_destory(&threads[i]);
+	}
+
+	p->use_workers = false;
+	gb_semaphore_destroy(&p->work_semaphore);
+	gb_free(heap_allocator(), threads);
+
+	if (p->worker_error != ParseFile_None) {
+		return p->worker_error;
+	}
 
+	parse_sort_files_by_import_order(p, initial_import_count);
+	for_array(i, p->files) {
+		p->total_line_count += p->files.e[i].tokenizer.line_count;
+	}
+	return ParseFile_None;
+}
 
 ParseFileError parse_files(Parser *p, char *init_filename) {
 	char *fullpath_str = gb_path_get_full_name(heap_allocator(), init_filename);
@@ -4129,61 +4496,37 @@ ParseFileError parse_files(Parser *p, char *init_filename) {
 	array_add(&p->imports, init_imported_file);
 	p->init_fullpath = init_fullpath;
 
-	for_array(i, p->imports) {
-		ImportedFile imported_file = p->imports.e[i];
-		String import_path = imported_file.path;
-		String import_rel_path = imported_file.rel_path;
-		TokenPos pos = imported_file.pos;
-		AstFile file = {0};
-
-		ParseFileError err = init_ast_file(&file, import_path);
-
+	if (build_context.thread_count > 1) {
+		ParseFileError err = parse_files_with_workers(p);
 		if (err != ParseFile_None) {
-			if (err == ParseFile_EmptyFile) {
-				if (str_eq(import_path, init_fullpath)) {
-					gb_printf_err("Initial file is empty - %.*s\n", LIT(init_fullpath));
-					gb_exit(1);
-				}
-				return ParseFile_None;
-			}
+			return err;
+		}
+	} else {
+		for_array(i, p->imports) {
+			ImportedFile imported_file = p->imports.e[i];
+			AstFile file = {0};
 
-			if (pos.line != 0) {
-				gb_printf_err("%.*s(%td:%td) ", LIT(pos.file), pos.line, pos.column);
+			ParseFileError err = parse_imported_file(p, imported_file, &file);
+			if (err == ParseFile_EmptyFile) {
+				// NOTE: Skipped as the workers do, the rest of the imports are still parsed
+				continue;
 			}
-			gb_printf_err("Failed to parse file: %.*s\n\t", LIT(import_rel_path));
-			switch (err) {
-			case ParseFile_WrongExtension:
-				gb_printf_err("Invalid file extension: File must have the extension `.odin`");
-				break;
-			case ParseFile_InvalidFile:
-				gb_printf_err("Invalid file or cannot be found");
-				break;
-			case ParseFile_Permission:
-				gb_printf_err("File permissions problem");
-				break;
-			case ParseFile_NotFound:
-				gb_printf_err("File cannot be found (`%.*s`)", LIT(import_path));
-				break;
-			case ParseFile_InvalidToken:
-				gb_printf_err("Invalid token found in file");
-				break;
+			if (err != ParseFile_None) {
+				return err;
 			}
-			gb_printf_err("\n");
-			return err;
-		}
-		parse_file(p, &file);
 
-		{
-			gb_mutex_lock(&p->mutex);
-			file.id = p->files.count;
-			array_add(&p->files, file);
-			p->total_line_count += file.tokenizer.line_count;
-			gb_mutex_unlock(&p->mutex);
+			{
+				gb_mutex_lock(&p->mutex);
+				file.id = p->files.count;
+				array_add(&p->files, file);
+				p->total_line_count += file.tokenizer.line_count;
+				gb_mutex_unlock(&p->mutex);
+			}
 		}
 	}
 
 	for_array(i, p->files) {
-		p->total_token_count += p->files.e[i].tokens.count;
+		p->total_token_count += p->files.e[i].token_count;
 	}
 
 
@@ -0,0 +1,472 @@
+// NOTE: `odin serve <socket>` is a long-lived compiler that listens on a Unix socket. It sets up the
+// universal scope once and parses every file of core/ up front. A command given `-server=<socket>`
+// is sent to it rather than being run (see `server_forward_command`). The client's cwd, arguments,
+// environment and standard streams go with the command.
+//
+// For each command the server forks a child that runs it just like `main` would. The child shares
+// the parsed files of core/ with the server, see `preparsed_files`, and only parses the files that
+// are not among them. Forking keeps every build isolated: whatever a build does to the ASTs or to
+// the global state of the checker is gone when its child exits. Commands are run one at a time.
+//
+// The checker still checks core on every build, as it cannot check part of a program again.
+
+#if defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <dirent.h>
+
+int run_command(Timings *timings, int argc, char **argv);
+
+#define SERVER_MAX_REQUEST gb_megabytes(1)
+
+// NOTE: Sent first, along with the client's stdin, stdout and stderr
+typedef struct ServerRequestHeader {
+	u32 size; // NOTE: Of the cwd, arguments and environment that follow, each null terminated
+	i32 argc;
+	i32 envc;
+} ServerRequestHeader;
+
+bool server__socket_address(struct sockaddr_un *addr, String path) {
+	gb_zero_item(addr);
+	addr->sun_family = AF_UNIX;
+	if (path.len == 0 || path.len >= gb_size_of(addr->sun_path)) {
+		gb_printf_err("Invalid socket path: `%.*s`\n", LIT(path));
+		return false;
+	}
+	gb_memmove(addr->sun_path, path.text, path.len);
+	return true;
+}
+
+bool server__write_all(int fd, void const *data, isize size) {
+	u8 const *bytes = cast(u8 const *)data;
+	while (size > 0) {
+		ssize_t n = write(fd, bytes, size);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		bytes += n;
+		size  -= n;
+	}
+	return true;
+}
+
+bool server__read_all(int fd, void *data, isize size) {
+	u8 *bytes = cast(u8 *)data;
+	while (size > 0) {
+		ssize_t n = read(fd, bytes, size);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		bytes += n;
+		size  -= n;
+	}
+	return true;
+}
+
+// NOTE: Changes whenever the file is written to or replaced
+u64 server__file_stamp(String fullpath) {
+	struct stat st = {0};
+	if (stat(gb_bprintf("%.*s", LIT(fullpath)), &st) != 0) {
+		return 0;
+	}
+	u64 parts[4] = {cast(u64)st.st_size, cast(u64)st.st_ino, cast(u64)st.st_mtim.tv_sec, cast(u64)st.st_mtim.tv_nsec};
+	return gb_fnv64a(parts, gb_size_of(parts));
+}
+
+// NOTE: A file of core/ as last seen by the server
+typedef struct ServerFile {
+	String  fullpath;
+	u64     stamp;
+	bool    is_parsed; // NOTE: False if it had syntax errors, so builds parse it and report them
+	AstFile file;
+} ServerFile;
+
+typedef Array(ServerFile) ServerFileArray;
+
+gb_global ServerFileArray server_files = {0};
+
+bool server__parse_file(ServerFile *sf) {
+	Parser scratch = {0};
+	init_parser(&scratch);
+	ErrorCollector errors = global_error_collector;
+
+	ImportedFile imported_file = {sf->fullpath, sf->fullpath};
+	AstFile file = {0};
+	ParseFileError err = parse_imported_file(&scratch, imported_file, &file);
+	bool ok = err == ParseFile_None && global_error_collector.count == errors.count;
+
+	global_error_collector.prev  = errors.prev;
+	global_error_collector.count = errors.count;
+	array_free(&scratch.imports);
+	array_free(&scratch.files);
+	if (ok) {
+		sf->file = file;
+	}
+	return ok;
+}
+
+// NOTE: Parses the files of core/ that were added or changed since the last call, then makes the
+// parsed files available to builds. Replaced files are leaked.
+void server_update_core(void) {
+	// NOTE: So that `parse_imported_file` really parses the files
+	array_clear(&preparsed_files.files);
+	map_isize_clear(&preparsed_files.index);
+
+	String core_dir = get_fullpath_core(heap_allocator(), str_lit(""));
+	DIR *dir = core_dir.len > 0 ? opendir(gb_bprintf("%.*s", LIT(core_dir))) : NULL;
+	if (dir == NULL) {
+		gb_printf_err("Could not open the core directory\n");
+		return;
+	}
+
+	ServerFileArray files = {0};
+	array_init(&files, heap_allocator());
+	for (;;) {
+		struct dirent *de = readdir(dir);
+		if (de == NULL) {
+			break;
+		}
+		String name = make_string_c(de->d_name);
+		if (!string_has_extension(name, str_lit("odin"))) {
+			continue;
+		}
+
+		String fullpath = get_fullpath_core(heap_allocator(), name);
+		if (fullpath.len == 0) {
+			continue; // NOTE: Removed since it was listed
+		}
+		u64 stamp = server__file_stamp(fullpath);
+		ServerFile *prev = NULL;
+		for_array(i, server_files) {
+			if (str_eq(server_files.e[i].fullpath, fullpath)) {
+				prev = &server_files.e[i];
+				break;
+			}
+		}
+
+		if (prev != NULL && prev->stamp == stamp) {
+			gb_free(heap_allocator(), fullpath.text);
+			array_add(&files, *prev);
+			continue;
+		}
+		ServerFile sf = {0};
+		sf.fullpath  = fullpath;
+		sf.stamp     = stamp;
+		sf.is_parsed = server__parse_file(&sf);
+		array_add(&files, sf);
+	}
+	closedir(dir);
+	gb_free(heap_allocator(), core_dir.text);
+
+	array_free(&server_files);
+	server_files = files;
+	for_array(i, server_files) {
+		ServerFile *sf = &server_files.e[i];
+		if (sf->is_parsed) {
+			map_isize_set(&preparsed_files.index, hash_string(sf->file.tokenizer.fullpath), preparsed_files.files.count);
+			array_add(&preparsed_files.files, sf->file);
+		}
+	}
+}
+
+// NOTE: Points `strings` at the next `count` null terminated strings of the payload, which must end
+// with a null. `strings` is null terminated too.
+char *server__split_strings(char *curr, char *end, i32 count, char ***strings_) {
+	char **strings = gb_alloc_array(heap_allocator(), char *, count+1);
+	for (i32 i = 0; i < count; i++) {
+		if (curr >= end) {
+			gb_free(heap_allocator(), strings);
+			return NULL;
+		}
+		strings[i] = curr;
+		curr += gb_strlen(curr)+1;
+	}
+	strings[count] = NULL;
+	*strings_ = strings;
+	return curr;
+}
+
+// NOTE: Receives the header and the client's standard streams, returns false if the client is
+// gone or sent something malformed
+bool server__receive_header(int conn, ServerRequestHeader *header, int fds[3]) {
+	// NOTE: Room for more than the three streams, so that extra descriptors are received and closed
+	char control[CMSG_SPACE(8*gb_size_of(int))] = {0};
+	struct iovec iov = {header, gb_size_of(*header)};
+	struct msghdr msg = {0};
+	msg.msg_iov        = &iov;
+	msg.msg_iovlen     = 1;
+	msg.msg_control    = control;
+	msg.msg_controllen = gb_size_of(control);
+
+	ssize_t n = recvmsg(conn, &msg, 0);
+	if (n < 0) {
+		return false;
+	}
+
+	// NOTE: Every descriptor that came with the message is already open in this process, so all of
+	// them are closed unless they are exactly the three streams
+	bool ok = (msg.msg_flags & MSG_CTRUNC) == 0;
+	isize fd_count = 0;
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+		if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+			ok = false;
+			continue;
+		}
+		u8 *data = cast(u8 *)CMSG_DATA(cmsg);
+		isize count = (cmsg->cmsg_len - (data - cast(u8 *)cmsg)) / gb_size_of(int);
+		for (isize i = 0; i < count; i++) {
+			int fd = -1;
+			gb_memmove(&fd, data + i*gb_size_of(int), gb_size_of(int));
+			if (fd_count < 3) {
+				fds[fd_count] = fd;
+			} else {
+				close(fd);
+			}
+			fd_count++;
+		}
+	}
+	if (fd_count != 3 || n != gb_size_of(*header) ||
+	    header->size == 0 || header->size > SERVER_MAX_REQUEST || header->argc < 2 || header->envc < 0) {
+		ok = false;
+	}
+	if (!ok) {
+		for (isize i = 0; i < gb_min(fd_count, 3); i++) {
+			close(fds[i]);
+			fds[i] = -1;
+		}
+		return false;
+	}
+	for (isize i = 0; i < 3; i++) {
+		fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+	}
+	return true;
+}
+
+// NOTE: The command runs with the client's environment, so only the user that runs the server may
+// use it
+bool server__peer_is_same_user(int conn) {
+#if defined(GB_SYSTEM_OSX)
+	uid_t uid = 0;
+	gid_t gid = 0;
+	if (getpeereid(conn, &uid, &gid) != 0) {
+		return false;
+	}
+#else
+	struct ucred cred = {0};
+	socklen_t len = gb_size_of(cred);
+	if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0 || len != gb_size_of(cred)) {
+		return false;
+	}
+	uid_t uid = cred.uid;
+#endif
+	return uid == getuid();
+}
+
+void server__handle_connection(int listener, int conn) {
+	ServerRequestHeader header = {0};
+	int fds[3] = {-1, -1, -1};
+	if (!server__receive_header(conn, &header, fds)) {
+		return;
+	}
+
+	char *payload = gb_alloc_array(heap_allocator(), char, header.size);
+	char *end = payload+header.size;
+	char *cwd = payload;
+	char **argv = NULL;
+	char **envp = NULL;
+	bool ok = server__read_all(conn, payload, header.size) && end[-1] == 0;
+	if (ok) {
+		char *curr = server__split_strings(cwd+gb_strlen(cwd)+1, end, header.argc, &argv);
+		ok = curr != NULL && server__split_strings(curr, end, header.envc, &envp) != NULL;
+	}
+
+	i32 exit_code = 1;
+	if (ok) {
+		server_update_core();
+
+		pid_t pid = fork();
+		if (pid == 0) {
+			close(listener);
+			close(conn);
+			for (int i = 0; i < 3; i++) {
+				dup2(fds[i], i);
+			}
+			signal(SIGPIPE, SIG_DFL);
+			environ = envp; // NOTE: e.g. the PATH used to find opt and llc
+			if (chdir(cwd) != 0) {
+				gb_printf_err("Could not change to the directory: %s\n", cwd);
+				_exit(1);
+			}
+
+			Timings timings = {0};
+			timings_init(&timings, str_lit("Total Time"), 128);
+			_exit(run_command(&timings, header.argc, argv));
+		}
+		if (pid < 0) {
+			gb_printf_err("Could not fork to run the command\n");
+		} else {
+			exit_code = exec__wait_pid(pid);
+		}
+	}
+	if (argv != NULL) gb_free(heap_allocator(), argv);
+	if (envp != NULL) gb_free(heap_allocator(), envp);
+
+	for (isize i = 0; i < 3; i++) {
+		close(fds[i]);
+	}
+	gb_free(heap_allocator(), payload);
+	server__write_all(conn, &exit_code, gb_size_of(exit_code));
+}
+
+int server_run(String socket_path) {
+	struct sockaddr_un addr = {0};
+	if (!server__socket_address(&addr, socket_path)) {
+		return 1;
+	}
+	struct stat st = {0};
+	if (lstat(addr.sun_path, &st) == 0 && !S_ISSOCK(st.st_mode)) {
+		gb_printf_err("`%.*s` exists and is not a socket\n", LIT(socket_path));
+		return 1;
+	}
+
+	array_init(&server_files, heap_allocator());
+	array_init(&preparsed_files.files, heap_allocator());
+	map_isize_init(&preparsed_files.index, heap_allocator());
+	server_update_core();
+	gb_printf("Parsed %td core files\n", preparsed_files.files.count);
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) {
+		gb_printf_err("Could not create a socket\n");
+		return 1;
+	}
+	fcntl(listener, F_SETFD, FD_CLOEXEC);
+	if (lstat(addr.sun_path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+		unlink(addr.sun_path); // NOTE: Left behind by a server that did not exit cleanly
+	}
+	mode_t old_mask = umask(0077); // NOTE: Create the socket as 0600
+	bool bound = bind(listener, cast(struct sockaddr *)&addr, gb_size_of(addr)) == 0;
+	umask(old_mask);
+	if (!bound || listen(listener, 16) != 0) {
+		gb_printf_err("Could not listen on `%.*s`\n", LIT(socket_path));
+		close(listener);
+		return 1;
+	}
+	// NOTE: A client that goes away must not kill the server
+	signal(SIGPIPE, SIG_IGN);
+	gb_printf("Listening on %.*s\n", LIT(socket_path));
+
+	for (;;) {
+		int conn = accept(listener, NULL, NULL);
+		if (conn < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			gb_printf_err("Could not accept a connection\n");
+			break;
+		}
+		fcntl(conn, F_SETFD, FD_CLOEXEC);
+		if (server__peer_is_same_user(conn)) {
+			server__handle_connection(listener, conn);
+		} else {
+			gb_printf_err("Refused a connection from another user\n");
+		}
+		close(conn);
+	}
+
+	close(listener);
+	unlink(addr.sun_path);
+	return 1;
+}
+
+// NOTE: If a `-server=<socket>` flag is given and a server is listening there, runs the command on
+// the server and returns true. Otherwise the command is run by this process.
+bool server_forward_command(int argc, char **argv, i32 *exit_code_) {
+	String socket_path = {0};
+	for (int i = 2; i < argc; i++) {
+		String flag = make_string_c(argv[i]);
+		String prefix = str_lit("-server=");
+		if (str_has_prefix(flag, prefix)) {
+			socket_path = make_string(flag.text+prefix.len, flag.len-prefix.len);
+		}
+	}
+	if (socket_path.len == 0) {
+		return false;
+	}
+
+	struct sockaddr_un addr = {0};
+	if (!server__socket_address(&addr, socket_path)) {
+		return false;
+	}
+	int conn = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (conn < 0) {
+		return false;
+	}
+	if (connect(conn, cast(struct sockaddr *)&addr, gb_size_of(addr)) != 0) {
+		gb_printf_err("No server is listening on `%.*s`, building without one\n", LIT(socket_path));
+		close(conn);
+		return false;
+	}
+
+	char *cwd = gb_alloc_array(heap_allocator(), char, PATH_MAX);
+	if (getcwd(cwd, PATH_MAX) == NULL) {
+		close(conn);
+		return false;
+	}
+	gbString payload = gb_string_make_length(heap_allocator(), cwd, gb_strlen(cwd)+1);
+	i32 forwarded_argc = 0;
+	for (int i = 0; i < argc; i++) {
+		if (i >= 2 && gb_str_has_prefix(argv[i], "-server=")) {
+			continue;
+		}
+		payload = gb_string_append_length(payload, argv[i], gb_strlen(argv[i])+1);
+		forwarded_argc++;
+	}
+	i32 envc = 0;
+	for (char **env = environ; *env != NULL; env++) {
+		payload = gb_string_append_length(payload, *env, gb_strlen(*env)+1);
+		envc++;
+	}
+
+	ServerRequestHeader header = {0};
+	header.size = cast(u32)gb_string_length(payload);
+	header.argc = forwarded_argc;
+	header.envc = envc;
+
+	int fds[3] = {0, 1, 2};
+	char control[CMSG_SPACE(3*gb_size_of(int))] = {0};
+	struct iovec iov = {&header, gb_size_of(header)};
+	struct msghdr msg = {0};
+	msg.msg_iov        = &iov;
+	msg.msg_iovlen     = 1;
+	msg.msg_control    = control;
+	msg.msg_controllen = gb_size_of(control);
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type  = SCM_RIGHTS;
+	cmsg->cmsg_len   = CMSG_LEN(gb_size_of(fds));
+	gb_memmove(CMSG_DATA(cmsg), fds, gb_size_of(fds));
+
+	i32 exit_code = 1;
+	bool ok = header.size <= SERVER_MAX_REQUEST &&
+	          sendmsg(conn, &msg, 0) == gb_size_of(header) &&
+	          server__write_all(conn, payload, header.size) &&
+	          server__read_all(conn, &exit_code, gb_size_of(exit_code));
+	if (!ok) {
+		gb_printf_err("The server on `%.*s` did not finish the command\n", LIT(socket_path));
+		exit_code = 1;
+	}
+
+	gb_string_free(payload);
+	gb_free(heap_allocator(), cwd);
+	close(conn);
+	*exit_code_ = exit_code;
+	return true;
+}
+#endif
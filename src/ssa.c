@@ -161,7 +161,7 @@ struct ssaModule {
 	gbAllocator        tmp_allocator;
 	gbArena            tmp_arena;
 
-	MapEntity          min_dep_map; // Key: Entity *
+	EntitySet          min_dep_set;
 	MapSsaValue        values;      // Key: Entity *
 	// List of registers for the specific architecture
 	Array(ssaRegister) registers;
@@ -599,9 +599,8 @@ ssaAddr ssa_add_local(ssaProc *p, Entity *e, AstNode *expr) {
 	return ssa_addr(local);
 }
 ssaAddr ssa_add_local_for_ident(ssaProc *p, AstNode *name) {
-	Entity **found = map_entity_get(&p->module->info->definitions, hash_pointer(name));
-	if (found) {
-		Entity *e = *found;
+	Entity *e = definition_of_ident(p->module->info, name);
+	if (e != NULL) {
 		return ssa_add_local(p, e, name);
 	}
 
@@ -1155,7 +1154,7 @@ ssaAddr ssa_build_addr(ssaProc *p, AstNode *expr) {
 	         "\tAstNode: %.*s @ "
 	         "%.*s(%td:%td)\n",
 	         LIT(ast_node_strings[expr->kind]),
-	         LIT(token_pos.file), token_pos.line, token_pos.column);
+	         LIT(token_pos_file(token_pos)), token_pos_line(token_pos), token_pos_column(token_pos));
 
 
 	return ssa_addr(NULL);
@@ -1681,16 +1680,16 @@ ssaValue *ssa_build_expr(ssaProc *p, AstNode *expr) {
 
 	case_ast_node(bd, BasicDirective, expr);
 		TokenPos pos = bd->token.pos;
-		GB_PANIC("Non-constant basic literal %.*s(%td:%td) - %.*s", LIT(pos.file), pos.line, pos.column, LIT(bd->name));
+		GB_PANIC("Non-constant basic literal %.*s(%td:%td) - %.*s", LIT(token_pos_file(pos)), token_pos_line(pos), token_pos_column(pos), LIT(bd->name));
 	case_end;
 
 	case_ast_node(i, Ident, expr);
-		Entity *e = *map_entity_get(&p->module->info->uses, hash_pointer(expr));
+		Entity *e = use_of_ident(p->module->info, expr);
 		if (e->kind == Entity_Builtin) {
 			Token token = ast_node_token(expr);
 			GB_PANIC("TODO(bill): ssa_build_expr Entity_Builtin `%.*s`\n"
 			         "\t at %.*s(%td:%td)", LIT(builtin_procs[e->Builtin.id].name),
-			         LIT(token.pos.file), token.pos.line, token.pos.column);
+			         LIT(token_pos_file(token.pos)), token_pos_line(token.pos), token_pos_column(token.pos));
 			return NULL;
 		} else if (e->kind == Entity_Nil) {
 			GB_PANIC("TODO(bill): nil");
@@ -1835,7 +1834,7 @@ ssaValue *ssa_build_expr(ssaProc *p, AstNode *expr) {
 
 
 	case_ast_node(ce, CallExpr, expr);
-		if (map_tav_get(&p->module->info->types, hash_pointer(ce->proc))->mode == Addressing_Type) {
+		if (type_and_value_of_expr(p->module->info, ce->proc).mode == Addressing_Type) {
 			GB_ASSERT(ce->args.count == 1);
 			ssaValue *x = ssa_build_expr(p, ce->args.e[0]);
 			return ssa_emit_conv(p, x, tv.type);
@@ -2514,7 +2513,7 @@ bool ssa_generate(Parser *parser, CheckerInfo *info) {
 
 
 	m.entry_point_entity = entry_point;
-	m.min_dep_map = generate_minimum_dependency_map(info, entry_point);
+	m.min_dep_set = generate_minimum_dependency_set(info, entry_point);
 
 	for_array(i, info->entities.entries) {
 		MapDeclInfoEntry *entry = &info->entities.entries.e[i];
@@ -2527,7 +2526,7 @@ bool ssa_generate(Parser *parser, CheckerInfo *info) {
 			continue;
 		}
 
-		if (map_entity_get(&m.min_dep_map, hash_pointer(e)) == NULL) {
+		if (!entity_set_has(&m.min_dep_set, e)) {
 			// NOTE(bill): Nothing depends upon it so doesn't need to be built
 			continue;
 		}
@@ -2538,7 +2537,7 @@ bool ssa_generate(Parser *parser, CheckerInfo *info) {
 				// Handle later
 			} else if (scope->is_init && e->kind == Entity_Procedure && str_eq(name, str_lit("main"))) {
 			} else {
-				name = ssa_mangle_name(&m, e->token.pos.file, e);
+				name = ssa_mangle_name(&m, token_pos_file(e->token.pos), e);
 			}
 		}
 
@@ -119,7 +119,7 @@ gb_inline bool str_ge(String a, String b) { return string_compare(a, b) >= 0;
 
 gb_inline bool str_has_prefix(String s, String prefix) {
 	isize i;
-	if (prefix.len < s.len) {
+	if (prefix.len > s.len) {
 		return false;
 	}
 	for (i = 0; i < prefix.len; i++) {
@@ -1,17 +1,44 @@
+// NOTE: Wall time is measured with `time_stamp_time_now` in units of `time_stamp__freq`.
+// CPU time of this process and of the child processes it has waited on (opt, llc, the linker)
+// is measured separately, always in nanoseconds.
 typedef struct TimeStamp {
 	u64    start;
 	u64    finish;
+	u64    cpu_start;
+	u64    cpu_finish;
+	u64    child_start;
+	u64    child_finish;
 	String label;
 } TimeStamp;
 
+// NOTE: A count of things processed during a section, reported as a rate
+typedef struct TimingsCounter {
+	isize  section;
+	String label;
+	i64    count;
+} TimingsCounter;
+
+// NOTE: Describes the build, e.g. the build profile, so a report shows what was measured
+typedef struct TimingsInfo {
+	String label;
+	String value;
+} TimingsInfo;
+
 typedef struct Timings {
-	TimeStamp        total;
-	Array(TimeStamp) sections;
-	u64              freq;
+	TimeStamp             total;
+	Array(TimeStamp)      sections;
+	Array(TimingsCounter) counters;
+	Array(TimingsInfo)    infos;
+	u64                   freq;
 } Timings;
 
 
 #if defined(GB_SYSTEM_WINDOWS)
+#include <psapi.h>
+
+// NOTE: 100ns units, accumulated by `system_exec_command_line_app`
+gb_global u64 win32_child_cpu_time = 0;
+
 u64 win32_time_stamp_time_now(void) {
 	LARGE_INTEGER counter;
 	QueryPerformanceCounter(&counter);
@@ -28,27 +55,76 @@ u64 win32_time_stamp__freq(void) {
 	return win32_perf_count_freq.QuadPart;
 }
 
+u64 win32_filetime_to_u64(FILETIME ft) {
+	return (cast(u64)ft.dwHighDateTime << 32) | cast(u64)ft.dwLowDateTime;
+}
+
+u64 win32_process_cpu_time(HANDLE process) {
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(process, &creation, &exit, &kernel, &user)) {
+		return 0;
+	}
+	return win32_filetime_to_u64(kernel) + win32_filetime_to_u64(user);
+}
+
+u64 win32_time_stamp_cpu_now(void) {
+	return 100 * win32_process_cpu_time(GetCurrentProcess());
+}
+
+u64 win32_time_stamp_child_cpu_now(void) {
+	return 100 * win32_child_cpu_time;
+}
+
+i64 win32_peak_rss(void) {
+	PROCESS_MEMORY_COUNTERS pmc = {0};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, gb_size_of(pmc))) {
+		return 0;
+	}
+	return cast(i64)pmc.PeakWorkingSetSize;
+}
+
 #elif defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
 
 #include <time.h>
+#include <sys/resource.h>
 
 u64 unix_time_stamp_time_now(void) {
 	struct timespec ts;
-	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	clock_gettime(CLOCK_MONOTONIC, &ts);
 
 	return (ts.tv_sec * 1000000000) + ts.tv_nsec;
 }
 
 u64 unix_time_stamp__freq(void) {
-	gb_local_persist u64 freq = 0;
+	return 1000000000;
+}
 
-	if (freq == 0) {
-		struct timespec ts;
-		clock_getres(CLOCK_PROCESS_CPUTIME_ID, &ts);
-		freq = cast(u64) ((1.0 / ts.tv_nsec) * 1000000000.0);
-	}
+u64 unix_time_stamp_cpu_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
 
-	return freq;
+	return (ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+u64 unix_timeval_to_ns(struct timeval tv) {
+	return (cast(u64)tv.tv_sec * 1000000000) + (cast(u64)tv.tv_usec * 1000);
+}
+
+// NOTE: Only covers children that have been waited on, which `system` always does
+u64 unix_time_stamp_child_cpu_now(void) {
+	struct rusage usage = {0};
+	getrusage(RUSAGE_CHILDREN, &usage);
+	return unix_timeval_to_ns(usage.ru_utime) + unix_timeval_to_ns(usage.ru_stime);
+}
+
+i64 unix_peak_rss(void) {
+	struct rusage usage = {0};
+	getrusage(RUSAGE_SELF, &usage);
+#if defined(GB_SYSTEM_OSX)
+	return cast(i64)usage.ru_maxrss; // NOTE: bytes
+#else
+	return cast(i64)usage.ru_maxrss * 1024; // NOTE: kilobytes
+#endif
 }
 
 #else
@@ -75,26 +151,69 @@ u64 time_stamp__freq(void) {
 #endif
 }
 
+u64 time_stamp_cpu_now(void) {
+#if defined(GB_SYSTEM_WINDOWS)
+	return win32_time_stamp_cpu_now();
+#elif defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+	return unix_time_stamp_cpu_now();
+#else
+#error time_stamp_cpu_now
+#endif
+}
+
+u64 time_stamp_child_cpu_now(void) {
+#if defined(GB_SYSTEM_WINDOWS)
+	return win32_time_stamp_child_cpu_now();
+#elif defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+	return unix_time_stamp_child_cpu_now();
+#else
+#error time_stamp_child_cpu_now
+#endif
+}
+
+// NOTE: In bytes
+i64 peak_resident_set_size(void) {
+#if defined(GB_SYSTEM_WINDOWS)
+	return win32_peak_rss();
+#elif defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+	return unix_peak_rss();
+#else
+#error peak_resident_set_size
+#endif
+}
+
 TimeStamp make_time_stamp(String label) {
 	TimeStamp ts = {0};
-	ts.start = time_stamp_time_now();
+	ts.start       = time_stamp_time_now();
+	ts.cpu_start   = time_stamp_cpu_now();
+	ts.child_start = time_stamp_child_cpu_now();
 	ts.label = label;
 	return ts;
 }
 
+void time_stamp_finish(TimeStamp *ts) {
+	ts->finish       = time_stamp_time_now();
+	ts->cpu_finish   = time_stamp_cpu_now();
+	ts->child_finish = time_stamp_child_cpu_now();
+}
+
 void timings_init(Timings *t, String label, isize buffer_size) {
 	array_init_reserve(&t->sections, heap_allocator(), buffer_size);
+	array_init(&t->counters, heap_allocator());
+	array_init(&t->infos,    heap_allocator());
 	t->total = make_time_stamp(label);
 	t->freq  = time_stamp__freq();
 }
 
 void timings_destroy(Timings *t) {
 	array_free(&t->sections);
+	array_free(&t->counters);
+	array_free(&t->infos);
 }
 
 void timings__stop_current_section(Timings *t) {
 	if (t->sections.count > 0) {
-		t->sections.e[t->sections.count-1].finish = time_stamp_time_now();
+		time_stamp_finish(&t->sections.e[t->sections.count-1]);
 	}
 }
 
@@ -103,17 +222,75 @@ void timings_start_section(Timings *t, String label) {
 	array_add(&t->sections, make_time_stamp(label));
 }
 
+// NOTE: Attaches `count` things (e.g. tokens) to the current section
+void timings_add_counter(Timings *t, String label, i64 count) {
+	GB_ASSERT(t->sections.count > 0);
+	TimingsCounter c = {0};
+	c.section = t->sections.count-1;
+	c.label   = label;
+	c.count   = count;
+	array_add(&t->counters, c);
+}
+
+void timings_add_info(Timings *t, String label, String value) {
+	TimingsInfo info = {0};
+	info.label = label;
+	info.value = value;
+	array_add(&t->infos, info);
+}
+
 f64 time_stamp_as_ms(TimeStamp ts, u64 freq) {
 	GB_ASSERT_MSG(ts.finish >= ts.start, "time_stamp_as_ms - %.*s", LIT(ts.label));
 	return 1000.0 * cast(f64)(ts.finish - ts.start) / cast(f64)freq;
 }
 
-void timings_print_all(Timings *t) {
+f64 time_stamp_cpu_as_ms(TimeStamp ts) {
+	return cast(f64)(ts.cpu_finish - ts.cpu_start) / 1000000.0;
+}
+
+f64 time_stamp_child_cpu_as_ms(TimeStamp ts) {
+	return cast(f64)(ts.child_finish - ts.child_start) / 1000000.0;
+}
+
+f64 timings_counter_rate(Timings *t, TimingsCounter c) {
+	f64 ms = time_stamp_as_ms(t->sections.e[c.section], t->freq);
+	if (ms <= 0) {
+		return 0;
+	}
+	return 1000.0 * cast(f64)c.count / ms;
+}
+
+void timings__finish(Timings *t) {
+	// NOTE: Only the first call counts, so printing and writing JSON report the same times
+	if (t->total.finish == 0) {
+		timings__stop_current_section(t);
+		time_stamp_finish(&t->total);
+	}
+}
+
+void timings__print_time_stamp(TimeStamp ts, u64 freq, isize max_len) {
 	char const SPACES[] = "                                                                ";
+	GB_ASSERT(max_len <= gb_size_of(SPACES)-1);
+
+	gb_printf("%.*s%.*s - %.3f ms wall, %.3f ms cpu",
+	          LIT(ts.label),
+	          cast(int)(max_len-ts.label.len), SPACES,
+	          time_stamp_as_ms(ts, freq),
+	          time_stamp_cpu_as_ms(ts));
+	if (ts.child_finish > ts.child_start) {
+		gb_printf(", %.3f ms child cpu", time_stamp_child_cpu_as_ms(ts));
+	}
+}
+
+void timings_print_all(Timings *t) {
 	isize max_len, i;
 
-	timings__stop_current_section(t);
-	t->total.finish = time_stamp_time_now();
+	timings__finish(t);
+
+	for_array(i, t->infos) {
+		TimingsInfo info = t->infos.e[i];
+		gb_printf("%.*s: %.*s\n", LIT(info.label), LIT(info.value));
+	}
 
 	max_len = t->total.label.len;
 	for_array(i, t->sections) {
@@ -121,18 +298,87 @@ void timings_print_all(Timings *t) {
 		max_len = gb_max(max_len, ts.label.len);
 	}
 
-	GB_ASSERT(max_len <= gb_size_of(SPACES)-1);
+	timings__print_time_stamp(t->total, t->freq, max_len);
+	gb_printf("\n");
+
+	for_array(i, t->sections) {
+		timings__print_time_stamp(t->sections.e[i], t->freq, max_len);
+		for_array(j, t->counters) {
+			TimingsCounter c = t->counters.e[j];
+			if (c.section == i) {
+				gb_printf(", %.0f %.*s/s", timings_counter_rate(t, c), LIT(c.label));
+			}
+		}
+		gb_printf("\n");
+	}
 
-	gb_printf("%.*s%.*s - %.3f ms\n",
-	          LIT(t->total.label),
-	          cast(int)(max_len-t->total.label.len), SPACES,
-	          time_stamp_as_ms(t->total, t->freq));
+	gb_printf("Peak RSS - %.3f MiB\n", cast(f64)peak_resident_set_size() / cast(f64)gb_megabytes(1));
+}
 
+void timings__write_json_time_stamp(gbFile *f, TimeStamp ts, u64 freq) {
+	gb_fprintf(f, "\"name\": \"%.*s\", \"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"child_cpu_ms\": %.3f",
+	           LIT(ts.label),
+	           time_stamp_as_ms(ts, freq),
+	           time_stamp_cpu_as_ms(ts),
+	           time_stamp_child_cpu_as_ms(ts));
+}
+
+void timings__write_json_string(gbFile *f, String s) {
+	gb_fprintf(f, "\"");
+	for (isize i = 0; i < s.len; i++) {
+		u8 c = s.text[i];
+		if (c == '"' || c == '\\') {
+			gb_fprintf(f, "\\%c", c);
+		} else if (c < 0x20) {
+			char const *hex = "0123456789abcdef";
+			gb_fprintf(f, "\\u00%c%c", hex[c>>4], hex[c&15]);
+		} else {
+			gb_fprintf(f, "%c", c);
+		}
+	}
+	gb_fprintf(f, "\"");
+}
+
+bool timings_write_json(Timings *t, String path) {
+	char *c_path = cast(char *)gb_alloc(heap_allocator(), path.len+1);
+	gb_memmove(c_path, path.text, path.len);
+	c_path[path.len] = 0;
+
+	gbFile f = {0};
+	gbFileError err = gb_file_create(&f, c_path);
+	gb_free(heap_allocator(), c_path);
+	if (err != gbFileError_None) {
+		gb_printf_err("Unable to create timings file: %.*s\n", LIT(path));
+		return false;
+	}
+
+	timings__finish(t);
+
+	gb_fprintf(&f, "{\n\t\"build\": {");
+	for_array(i, t->infos) {
+		TimingsInfo info = t->infos.e[i];
+		gb_fprintf(&f, "%s\"%.*s\": ", i > 0 ? ", " : "", LIT(info.label));
+		timings__write_json_string(&f, info.value);
+	}
+	gb_fprintf(&f, "},\n\t\"total\": {");
+	timings__write_json_time_stamp(&f, t->total, t->freq);
+	gb_fprintf(&f, "},\n\t\"peak_rss_bytes\": %lld,\n", cast(long long)peak_resident_set_size());
+	gb_fprintf(&f, "\t\"sections\": [\n");
 	for_array(i, t->sections) {
-		TimeStamp ts = t->sections.e[i];
-		gb_printf("%.*s%.*s - %.3f ms\n",
-		          LIT(ts.label),
-	              cast(int)(max_len-ts.label.len), SPACES,
-		          time_stamp_as_ms(ts, t->freq));
+		gb_fprintf(&f, "\t\t{");
+		timings__write_json_time_stamp(&f, t->sections.e[i], t->freq);
+		for_array(j, t->counters) {
+			TimingsCounter c = t->counters.e[j];
+			if (c.section == i) {
+				gb_fprintf(&f, ", \"%.*s\": %lld, \"%.*s_per_second\": %.0f",
+				           LIT(c.label), cast(long long)c.count,
+				           LIT(c.label), timings_counter_rate(t, c));
+			}
+		}
+		gb_fprintf(&f, "}%s\n", i+1 < t->sections.count ? "," : "");
 	}
+	gb_fprintf(&f, "\t]\n}\n");
+
+	gb_file_close(&f);
+	return true;
 }
@@ -129,65 +129,339 @@ String const token_strings[] = {
 };
 
 
+// NOTE: Keywords are classified with a perfect hash over their first byte, last byte and length.
+// The multipliers are searched for at startup so adding a keyword cannot silently cause a collision.
+#define KEYWORD_HASH_TABLE_MAX 256
+
+typedef struct KeywordHashTable {
+	TokenKind kinds[KEYWORD_HASH_TABLE_MAX]; // NOTE: Token_Invalid if empty
+	u32       mask;
+	u32       first_mul;
+	u32       last_mul;
+	isize     min_len;
+	isize     max_len;
+} KeywordHashTable;
+
+gb_global KeywordHashTable keyword_hash_table = {0};
+
+gb_inline u32 keyword_hash(KeywordHashTable *ht, u8 *text, isize len) {
+	return (text[0]*ht->first_mul + text[len-1]*ht->last_mul + cast(u32)len) & ht->mask;
+}
+
+void init_keyword_hash_table(void) {
+	KeywordHashTable *ht = &keyword_hash_table;
+	isize count = Token__KeywordEnd - (Token__KeywordBegin+1);
+	isize size = next_pow2(2*count);
+
+	ht->min_len = ISIZE_MAX;
+	ht->max_len = 0;
+	for (i32 k = Token__KeywordBegin+1; k < Token__KeywordEnd; k++) {
+		ht->min_len = gb_min(ht->min_len, token_strings[k].len);
+		ht->max_len = gb_max(ht->max_len, token_strings[k].len);
+	}
+
+	for (; size <= KEYWORD_HASH_TABLE_MAX; size *= 2) {
+		ht->mask = cast(u32)(size-1);
+		for (u32 first_mul = 1; first_mul < 256; first_mul++) {
+			for (u32 last_mul = 0; last_mul < 256; last_mul++) {
+				bool ok = true;
+				ht->first_mul = first_mul;
+				ht->last_mul  = last_mul;
+				gb_zero_array(ht->kinds, gb_count_of(ht->kinds));
+				for (i32 k = Token__KeywordBegin+1; k < Token__KeywordEnd; k++) {
+					String str = token_strings[k];
+					u32 h = keyword_hash(ht, str.text, str.len);
+					if (ht->kinds[h] != Token_Invalid) {
+						ok = false;
+						break;
+					}
+					ht->kinds[h] = cast(TokenKind)k;
+				}
+				if (ok) {
+					return;
+				}
+			}
+		}
+	}
+
+	GB_PANIC("Unable to find a perfect hash for the keywords");
+}
+
+// NOTE: Returns Token_Ident if `str` is not a keyword
+gb_inline TokenKind keyword_kind(String str) {
+	KeywordHashTable *ht = &keyword_hash_table;
+	if (gb_is_between(str.len, ht->min_len, ht->max_len)) {
+		TokenKind kind = ht->kinds[keyword_hash(ht, str.text, str.len)];
+		if (kind != Token_Invalid && str_eq(token_strings[kind], str)) {
+			return kind;
+		}
+	}
+	return Token_Ident;
+}
+
+
+// NOTE: Every file read by the tokenizer is registered in `token_files` so that a TokenPos only
+// needs a file id and a byte offset. Lines and columns are only needed for errors and debug
+// info, so they are recovered on demand from a table of line starts built on first use.
 typedef struct TokenPos {
-	String file;
-	isize  line;
-	isize  column;
+	u32 file_id; // NOTE: 0 if the position is not within a file
+	u32 offset;
 } TokenPos;
 
+typedef struct TokenFile {
+	String     fullpath;
+	u8 *       start;
+	isize      size;
+	gbAtomic32 has_line_starts; // NOTE: `line_starts` is never changed once this is set
+	Array(u32) line_starts;
+} TokenFile;
+
+#define TOKEN_FILE_MAX (1<<16)
+
+typedef struct TokenFileTable {
+	gbMutex     mutex;
+	isize       count;
+	TokenFile * files[TOKEN_FILE_MAX]; // NOTE: files[0] is unused
+} TokenFileTable;
+
+gb_global TokenFileTable token_files = {0};
+
+void init_token_files(void) {
+	gb_mutex_init(&token_files.mutex);
+	token_files.count = 1;
+}
+
+u32 register_token_file(String fullpath, u8 *start, isize size) {
+	TokenFile *f = gb_alloc_item(tagged_allocator(MemoryTag_Tokenizer), TokenFile);
+	f->fullpath = fullpath;
+	f->start    = start;
+	f->size     = size;
+
+	gb_mutex_lock(&token_files.mutex);
+	GB_ASSERT_MSG(token_files.count < TOKEN_FILE_MAX, "Too many source files");
+	u32 id = cast(u32)token_files.count++;
+	token_files.files[id] = f;
+	gb_mutex_unlock(&token_files.mutex);
+	return id;
+}
+
+gb_inline TokenFile *token_file_of(TokenPos pos) {
+	if (pos.file_id == 0) {
+		return NULL;
+	}
+	return token_files.files[pos.file_id];
+}
+
+String token_pos_file(TokenPos pos) {
+	TokenFile *f = token_file_of(pos);
+	if (f == NULL) {
+		String empty = {0};
+		return empty;
+	}
+	return f->fullpath;
+}
+
+// NOTE: Both are 1 based, or 0 if the position is not within a file
+void token_pos_line_column(TokenPos pos, isize *line_, isize *column_) {
+	TokenFile *f = token_file_of(pos);
+	*line_   = 0;
+	*column_ = 0;
+	if (f == NULL) {
+		return;
+	}
+
+	if (gb_atomic32_load(&f->has_line_starts) == 0) {
+		gb_mutex_lock(&token_files.mutex);
+		if (gb_atomic32_load(&f->has_line_starts) == 0) {
+			array_init(&f->line_starts, tagged_allocator(MemoryTag_Tokenizer));
+			array_add(&f->line_starts, 0);
+			for (isize i = 0; i < f->size; i++) {
+				if (f->start[i] == '\n') {
+					array_add(&f->line_starts, cast(u32)(i+1));
+				}
+			}
+			gb_mfence();
+			gb_atomic32_store(&f->has_line_starts, 1);
+		}
+		gb_mutex_unlock(&token_files.mutex);
+	}
+
+	// NOTE: Find the last line starting at or before the offset
+	isize lo = 0;
+	isize hi = f->line_starts.count-1;
+	while (lo < hi) {
+		isize mid = lo + (hi-lo+1)/2;
+		if (f->line_starts.e[mid] <= pos.offset) {
+			lo = mid;
+		} else {
+			hi = mid-1;
+		}
+	}
+	*line_   = lo+1;
+	*column_ = pos.offset - f->line_starts.e[lo] + 1;
+}
+
+isize token_pos_line(TokenPos pos) {
+	isize line, column;
+	token_pos_line_column(pos, &line, &column);
+	return line;
+}
+
+isize token_pos_column(TokenPos pos) {
+	isize line, column;
+	token_pos_line_column(pos, &line, &column);
+	return column;
+}
+
+// NOTE: Whether `b` is on a later line than `a`, without needing the line starts of the file
+bool token_pos_newline_between(TokenPos a, TokenPos b) {
+	TokenFile *f = token_file_of(b);
+	if (f == NULL || a.file_id != b.file_id) {
+		return token_pos_line(a) != token_pos_line(b);
+	}
+	isize end = gb_min(cast(isize)b.offset, f->size);
+	for (isize i = a.offset; i < end; i++) {
+		if (f->start[i] == '\n') {
+			return true;
+		}
+	}
+	return false;
+}
+
 i32 token_pos_cmp(TokenPos a, TokenPos b) {
-	if (a.line == b.line) {
-		if (a.column == b.column) {
-			isize min_len = gb_min(a.file.len, b.file.len);
-			return gb_memcompare(a.file.text, b.file.text, min_len);
+	if (a.file_id == b.file_id) {
+		if (a.offset == b.offset) {
+			return 0;
+		}
+		return (a.offset < b.offset) ? -1 : +1;
+	}
+
+	isize a_line, a_column, b_line, b_column;
+	token_pos_line_column(a, &a_line, &a_column);
+	token_pos_line_column(b, &b_line, &b_column);
+	if (a_line == b_line) {
+		if (a_column == b_column) {
+			return string_compare(token_pos_file(a), token_pos_file(b));
 		}
-		return (a.column < b.column) ? -1 : +1;
+		return (a_column < b_column) ? -1 : +1;
 	}
 
-	return (a.line < b.line) ? -1 : +1;
+	return (a_line < b_line) ? -1 : +1;
 }
 
 bool token_pos_eq(TokenPos a, TokenPos b) {
-	return token_pos_cmp(a, b) == 0;
+	return a.file_id == b.file_id && a.offset == b.offset;
 }
 
 typedef struct Token {
 	TokenKind kind;
-	String string;
-	TokenPos pos;
+	Atom      atom; // NOTE: Set for identifiers, `string` is then the interned copy
+	String    string;
+	TokenPos  pos;
 } Token;
 
 Token empty_token = {Token_Invalid};
-Token blank_token = {Token_Ident, {cast(u8 *)"_", 1}};
+Token blank_token = {Token_Ident, 0, {cast(u8 *)"_", 1}};
 
 Token make_token_ident(String s) {
-	Token t = {Token_Ident, s};
+	Token t = {Token_Ident};
+	t.atom   = intern_string(s);
+	t.string = atom_string(t.atom);
 	return t;
 }
 
+gb_inline HashKey hash_token(Token t) {
+	if (t.atom != 0) {
+		return hash_atom(t.atom);
+	}
+	return hash_string(t.string);
+}
+
+// NOTE: Use this instead of assigning `string`, which would leave `atom` naming the old text
+gb_inline void token_set_string(Token *t, String s) {
+	t->atom   = 0;
+	t->string = s;
+}
+
+
+typedef struct ErrorMessage {
+	TokenPos pos;
+	String   text; // NOTE: The whole message, as it would have been printed
+} ErrorMessage;
+
+typedef Array(ErrorMessage) ErrorMessageArray;
 
 typedef struct ErrorCollector {
 	TokenPos prev;
 	i64     count;
 	i64     warning_count;
 	gbMutex mutex;
+
+	// NOTE: While procedure bodies are checked, messages are kept and printed sorted by position
+	// once all are done, so that the output does not depend on which thread got there first
+	bool              buffered;
+	ErrorMessageArray buffer;
 } ErrorCollector;
 
 gb_global ErrorCollector global_error_collector;
+// NOTE: Used instead of `global_error_collector.prev` while buffered, as each thread is then
+// checking a procedure of its own
+gb_global gb_thread_local TokenPos error_buffered_prev;
+// NOTE: Index in `global_error_collector.buffer` of the last message of this thread, which is
+// what the lines given to `error_line` belong to
+gb_global gb_thread_local isize error_buffered_last = -1;
 
 void init_global_error_collector(void) {
 	gb_mutex_init(&global_error_collector.mutex);
+	array_init(&global_error_collector.buffer, heap_allocator());
+}
+
+TokenPos *error_prev_pos(void) {
+	if (global_error_collector.buffered) {
+		return &error_buffered_prev;
+	}
+	return &global_error_collector.prev;
+}
+
+void error_reset_prev_pos(void) {
+	TokenPos zero_pos = {0};
+	*error_prev_pos() = zero_pos;
+}
+
+// NOTE: Must be called with the mutex held
+void error_out(TokenPos pos, char *fmt, ...) {
+	va_list va;
+	va_start(va, fmt);
+	if (global_error_collector.buffered) {
+		char buf[4096];
+		isize len = gb_snprintf_va(buf, gb_size_of(buf), fmt, va);
+		if (len <= 0) { // NOTE: Truncated
+			len = gb_size_of(buf);
+			buf[len-1] = 0;
+		}
+		u8 *text = gb_alloc_array(heap_allocator(), u8, len);
+		gb_memmove(text, buf, len);
+		ErrorMessage msg = {0};
+		msg.pos  = pos;
+		msg.text = make_string(text, len-1);
+		array_add(&global_error_collector.buffer, msg);
+		error_buffered_last = global_error_collector.buffer.count-1;
+	} else {
+		gb_printf_err_va(fmt, va);
+	}
+	va_end(va);
 }
 
 void warning_va(Token token, char *fmt, va_list va) {
 	gb_mutex_lock(&global_error_collector.mutex);
 	global_error_collector.warning_count++;
 	// NOTE(bill): Duplicate error, skip it
-	if (!token_pos_eq(global_error_collector.prev, token.pos)) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) Warning: %s\n",
-		              LIT(token.pos.file), token.pos.line, token.pos.column,
-		              gb_bprintf_va(fmt, va));
+	TokenPos *prev = error_prev_pos();
+	if (!token_pos_eq(*prev, token.pos)) {
+		*prev = token.pos;
+		error_out(token.pos, "%.*s(%td:%td) Warning: %s\n",
+		          LIT(token_pos_file(token.pos)), token_pos_line(token.pos), token_pos_column(token.pos),
+		          gb_bprintf_va(fmt, va));
 	}
 
 	gb_mutex_unlock(&global_error_collector.mutex);
@@ -197,13 +471,14 @@ void error_va(Token token, char *fmt, va_list va) {
 	gb_mutex_lock(&global_error_collector.mutex);
 	global_error_collector.count++;
 	// NOTE(bill): Duplicate error, skip it
-	if (!token_pos_eq(global_error_collector.prev, token.pos)) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) %s\n",
-		              LIT(token.pos.file), token.pos.line, token.pos.column,
-		              gb_bprintf_va(fmt, va));
-	} else if (token.pos.line == 0) {
-		gb_printf_err("Error: %s\n", gb_bprintf_va(fmt, va));
+	TokenPos *prev = error_prev_pos();
+	if (!token_pos_eq(*prev, token.pos)) {
+		*prev = token.pos;
+		error_out(token.pos, "%.*s(%td:%td) %s\n",
+		          LIT(token_pos_file(token.pos)), token_pos_line(token.pos), token_pos_column(token.pos),
+		          gb_bprintf_va(fmt, va));
+	} else if (token.pos.file_id == 0) {
+		error_out(token.pos, "Error: %s\n", gb_bprintf_va(fmt, va));
 	}
 
 	gb_mutex_unlock(&global_error_collector.mutex);
@@ -213,13 +488,14 @@ void syntax_error_va(Token token, char *fmt, va_list va) {
 	gb_mutex_lock(&global_error_collector.mutex);
 	global_error_collector.count++;
 	// NOTE(bill): Duplicate error, skip it
-	if (!token_pos_eq(global_error_collector.prev, token.pos)) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) Syntax Error: %s\n",
-		              LIT(token.pos.file), token.pos.line, token.pos.column,
-		              gb_bprintf_va(fmt, va));
-	} else if (token.pos.line == 0) {
-		gb_printf_err("Error: %s\n", gb_bprintf_va(fmt, va));
+	TokenPos *prev = error_prev_pos();
+	if (!token_pos_eq(*prev, token.pos)) {
+		*prev = token.pos;
+		error_out(token.pos, "%.*s(%td:%td) Syntax Error: %s\n",
+		          LIT(token_pos_file(token.pos)), token_pos_line(token.pos), token_pos_column(token.pos),
+		          gb_bprintf_va(fmt, va));
+	} else if (token.pos.file_id == 0) {
+		error_out(token.pos, "Error: %s\n", gb_bprintf_va(fmt, va));
 	}
 
 	gb_mutex_unlock(&global_error_collector.mutex);
@@ -229,18 +505,92 @@ void syntax_warning_va(Token token, char *fmt, va_list va) {
 	gb_mutex_lock(&global_error_collector.mutex);
 	global_error_collector.warning_count++;
 	// NOTE(bill): Duplicate error, skip it
-	if (!token_pos_eq(global_error_collector.prev, token.pos)) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) Syntax Warning: %s\n",
-		              LIT(token.pos.file), token.pos.line, token.pos.column,
-		              gb_bprintf_va(fmt, va));
-	} else if (token.pos.line == 0) {
-		gb_printf_err("Warning: %s\n", gb_bprintf_va(fmt, va));
+	TokenPos *prev = error_prev_pos();
+	if (!token_pos_eq(*prev, token.pos)) {
+		*prev = token.pos;
+		error_out(token.pos, "%.*s(%td:%td) Syntax Warning: %s\n",
+		          LIT(token_pos_file(token.pos)), token_pos_line(token.pos), token_pos_column(token.pos),
+		          gb_bprintf_va(fmt, va));
+	} else if (token.pos.file_id == 0) {
+		error_out(token.pos, "Warning: %s\n", gb_bprintf_va(fmt, va));
 	}
 
 	gb_mutex_unlock(&global_error_collector.mutex);
 }
 
+// NOTE: Prints a line that continues the message this thread printed last, such as the
+// candidates of an ambiguous call, so that it stays with that message when buffered
+void error_line(char *fmt, ...) {
+	va_list va;
+	va_start(va, fmt);
+	gb_mutex_lock(&global_error_collector.mutex);
+	if (global_error_collector.buffered) {
+		char buf[4096];
+		isize len = gb_snprintf_va(buf, gb_size_of(buf), fmt, va);
+		if (len <= 0) { // NOTE: Truncated
+			len = gb_size_of(buf);
+			buf[len-1] = 0;
+		}
+		ErrorMessageArray *buffer = &global_error_collector.buffer;
+		if (error_buffered_last < 0) {
+			ErrorMessage msg = {0};
+			msg.pos = error_buffered_prev;
+			array_add(buffer, msg);
+			error_buffered_last = buffer->count-1;
+		}
+		ErrorMessage *msg = &buffer->e[error_buffered_last];
+		isize text_len = msg->text.len + len-1;
+		u8 *text = gb_alloc_array(heap_allocator(), u8, text_len+1);
+		gb_memmove(text, msg->text.text, msg->text.len);
+		gb_memmove(text+msg->text.len, buf, len);
+		gb_free(heap_allocator(), msg->text.text);
+		msg->text = make_string(text, text_len);
+	} else {
+		gb_printf_err_va(fmt, va);
+	}
+	gb_mutex_unlock(&global_error_collector.mutex);
+	va_end(va);
+}
+
+void begin_error_buffering(void) {
+	gb_mutex_lock(&global_error_collector.mutex);
+	global_error_collector.buffered = true;
+	gb_mutex_unlock(&global_error_collector.mutex);
+	error_reset_prev_pos();
+	error_buffered_last = -1;
+}
+
+GB_COMPARE_PROC(error_message_cmp) {
+	ErrorMessage *x = cast(ErrorMessage *)a;
+	ErrorMessage *y = cast(ErrorMessage *)b;
+	if (x->pos.file_id != y->pos.file_id) {
+		int cmp = string_compare(token_pos_file(x->pos), token_pos_file(y->pos));
+		if (cmp != 0) {
+			return cmp;
+		}
+	}
+	if (x->pos.offset != y->pos.offset) {
+		return x->pos.offset < y->pos.offset ? -1 : +1;
+	}
+	return string_compare(x->text, y->text);
+}
+
+// NOTE: Prints the buffered messages sorted by file path and then offset
+void end_error_buffering(void) {
+	gb_mutex_lock(&global_error_collector.mutex);
+	ErrorMessageArray *buffer = &global_error_collector.buffer;
+	gb_sort_array(buffer->e, buffer->count, error_message_cmp);
+	for_array(i, *buffer) {
+		String text = buffer->e[i].text;
+		gb_printf_err("%.*s", LIT(text));
+		gb_free(heap_allocator(), text.text);
+	}
+	array_clear(buffer);
+	global_error_collector.buffered = false;
+	gb_mutex_unlock(&global_error_collector.mutex);
+	error_buffered_last = -1;
+}
+
 
 
 void warning(Token token, char *fmt, ...) {
@@ -328,7 +678,9 @@ typedef struct TokenizerState {
 typedef struct Tokenizer {
 	String fullpath;
 	u8 *start;
-	u8 *end;
+	u8 *end;   // NOTE: *end is always a NUL sentinel
+	isize map_size; // NOTE: > 0 if `start` is a read-only memory mapped view of the file
+	u32   file_id;  // NOTE: Id of the file in `token_files`
 
 	Rune  curr_rune;   // current character
 	u8 *  curr;        // character pos
@@ -367,6 +719,7 @@ void tokenizer_err(Tokenizer *t, char *msg, ...) {
 		column = 1;
 	}
 
+	gb_mutex_lock(&global_error_collector.mutex);
 	gb_printf_err("%.*s(%td:%td) Syntax error: ", LIT(t->fullpath), t->line_count, column);
 
 	va_start(va, msg);
@@ -374,42 +727,277 @@ void tokenizer_err(Tokenizer *t, char *msg, ...) {
 	va_end(va);
 
 	gb_printf_err("\n");
+	gb_mutex_unlock(&global_error_collector.mutex);
 
 	t->error_count++;
 }
 
 void advance_to_next_rune(Tokenizer *t) {
-	if (t->read_curr < t->end) {
-		Rune rune;
-		isize width = 1;
-
-		t->curr = t->read_curr;
-		if (t->curr_rune == '\n') {
-			t->line = t->curr;
-			t->line_count++;
-		}
-		rune = *t->read_curr;
-		if (rune == 0) {
-			tokenizer_err(t, "Illegal character NUL");
-		} else if (rune >= 0x80) { // not ASCII
-			width = gb_utf8_decode(t->read_curr, t->end-t->read_curr, &rune);
-			if (rune == GB_RUNE_INVALID && width == 1)
-				tokenizer_err(t, "Illegal UTF-8 encoding");
-			else if (rune == GB_RUNE_BOM && t->curr-t->start > 0)
-				tokenizer_err(t, "Illegal byte order mark");
-		}
-		t->read_curr += width;
-		t->curr_rune = rune;
-	} else {
+	// NOTE: The contents are NUL terminated so only a NUL byte needs the end of buffer check
+	Rune rune = *t->read_curr;
+	if (rune == 0 && t->read_curr >= t->end) {
 		t->curr = t->end;
 		if (t->curr_rune == '\n') {
 			t->line = t->curr;
 			t->line_count++;
 		}
 		t->curr_rune = GB_RUNE_EOF;
+		return;
+	}
+
+	isize width = 1;
+	t->curr = t->read_curr;
+	if (t->curr_rune == '\n') {
+		t->line = t->curr;
+		t->line_count++;
+	}
+	if (rune == 0) {
+		tokenizer_err(t, "Illegal character NUL");
+	} else if (rune >= 0x80) { // not ASCII
+		width = gb_utf8_decode(t->read_curr, t->end-t->read_curr, &rune);
+		if (rune == GB_RUNE_INVALID && width == 1)
+			tokenizer_err(t, "Illegal UTF-8 encoding");
+		else if (rune == GB_RUNE_BOM && t->curr-t->start > 0)
+			tokenizer_err(t, "Illegal byte order mark");
+	}
+	t->read_curr += width;
+	t->curr_rune = rune;
+}
+
+////////////////////////////////////////////////////////////////
+//
+// ASCII Fast Paths
+//
+////////////////////////////////////////////////////////////////
+
+// NOTE: These scan runs of plain ASCII bytes (16 at a time with SSE2) and leave everything else
+// (non-ASCII, NUL, the end of the file) to advance_to_next_rune so the diagnostics stay the same.
+// They only read ahead when at least 16 bytes remain before `t->end`.
+
+#if defined(GB_CPU_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define TOKENIZER_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define TOKENIZER_USE_SSE2 0
+#endif
+
+// NOTE: Only turned off to compare against the rune by rune paths (see `odin bench_tokenizer`)
+gb_global bool tokenizer_use_fast_paths = true;
+
+gb_inline i32 tokenizer__lowest_bit(u32 mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return cast(i32)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+gb_inline i32 tokenizer__highest_bit(u32 mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse(&index, mask);
+	return cast(i32)index;
+#else
+	return 31 - __builtin_clz(mask);
+#endif
+}
+
+// NOTE: `nl_mask` has a bit set for each newline in the 16 bytes at `p`
+gb_inline void tokenizer__count_newlines(Tokenizer *t, u8 *p, u32 nl_mask) {
+	if (nl_mask != 0) {
+	#if defined(_MSC_VER)
+		t->line_count += __popcnt(nl_mask);
+	#else
+		t->line_count += __builtin_popcount(nl_mask);
+	#endif
+		t->line = p + tokenizer__highest_bit(nl_mask) + 1;
+	}
+}
+
+// NOTE: Moves past the current rune and every byte up to `p`, which must start a rune.
+// Newlines between `t->read_curr` and `p` must have been counted by the scan that found `p`.
+gb_inline void tokenizer__jump_to(Tokenizer *t, u8 *p) {
+	if (t->curr_rune == '\n') {
+		t->line_count++;
+		if (t->line < t->read_curr) { // NOTE: The scan may have already moved past a later newline
+			t->line = t->read_curr;
+		}
+	}
+	t->read_curr = p;
+	t->curr_rune = ' ';
+	advance_to_next_rune(t);
+}
+
+// NOTE: Returns the first byte from `p` that is not ' ', '\t', '\r' or '\n'
+u8 *tokenizer__scan_whitespace(Tokenizer *t, u8 *p) {
+#if TOKENIZER_USE_SSE2
+	__m128i space = _mm_set1_epi8(' ');
+	__m128i tab   = _mm_set1_epi8('\t');
+	__m128i cr    = _mm_set1_epi8('\r');
+	__m128i nl    = _mm_set1_epi8('\n');
+	while (t->end - p >= 16) {
+		__m128i v     = _mm_loadu_si128(cast(__m128i *)p);
+		__m128i is_nl = _mm_cmpeq_epi8(v, nl);
+		__m128i is_ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+		                             _mm_or_si128(_mm_cmpeq_epi8(v, cr), is_nl));
+		u32 ws_mask = cast(u32)_mm_movemask_epi8(is_ws);
+		u32 nl_mask = cast(u32)_mm_movemask_epi8(is_nl);
+		if (ws_mask != 0xffff) {
+			i32 n = tokenizer__lowest_bit(~ws_mask);
+			tokenizer__count_newlines(t, p, nl_mask & ((1u<<n)-1));
+			return p+n;
+		}
+		tokenizer__count_newlines(t, p, nl_mask);
+		p += 16;
+	}
+#endif
+	while (p < t->end) {
+		u8 c = *p;
+		if (c == '\n') {
+			t->line_count++;
+			t->line = p+1;
+		} else if (c != ' ' && c != '\t' && c != '\r') {
+			break;
+		}
+		p++;
+	}
+	return p;
+}
+
+// NOTE: Returns the first byte from `p` that is not [A-Za-z0-9_]
+u8 *tokenizer__scan_identifier(Tokenizer *t, u8 *p) {
+#if TOKENIZER_USE_SSE2
+	__m128i case_bit   = _mm_set1_epi8(0x20);
+	__m128i before_a   = _mm_set1_epi8('a'-1);
+	__m128i after_z    = _mm_set1_epi8('z'+1);
+	__m128i before_0   = _mm_set1_epi8('0'-1);
+	__m128i after_9    = _mm_set1_epi8('9'+1);
+	__m128i underscore = _mm_set1_epi8('_');
+	while (t->end - p >= 16) {
+		// NOTE: Bytes >= 0x80 are negative as signed bytes so they are never in range
+		__m128i v      = _mm_loadu_si128(cast(__m128i *)p);
+		__m128i lower  = _mm_or_si128(v, case_bit);
+		__m128i alpha  = _mm_and_si128(_mm_cmpgt_epi8(lower, before_a), _mm_cmpgt_epi8(after_z, lower));
+		__m128i digit  = _mm_and_si128(_mm_cmpgt_epi8(v, before_0), _mm_cmpgt_epi8(after_9, v));
+		__m128i ident  = _mm_or_si128(_mm_or_si128(alpha, digit), _mm_cmpeq_epi8(v, underscore));
+		u32 mask = cast(u32)_mm_movemask_epi8(ident);
+		if (mask != 0xffff) {
+			return p + tokenizer__lowest_bit(~mask);
+		}
+		p += 16;
+	}
+#endif
+	while (p < t->end) {
+		u8 c = *p;
+		if (!(gb_char_is_alpha(cast(char)c) || gb_char_is_digit(cast(char)c) || c == '_')) {
+			break;
+		}
+		p++;
+	}
+	return p;
+}
+
+// NOTE: Returns the first '\n', NUL or non-ASCII byte from `p`
+u8 *tokenizer__scan_line_comment(Tokenizer *t, u8 *p) {
+#if TOKENIZER_USE_SSE2
+	__m128i nl   = _mm_set1_epi8('\n');
+	__m128i zero = _mm_setzero_si128();
+	while (t->end - p >= 16) {
+		__m128i v = _mm_loadu_si128(cast(__m128i *)p);
+		__m128i stop = _mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, zero));
+		u32 mask = cast(u32)(_mm_movemask_epi8(stop) | _mm_movemask_epi8(v));
+		if (mask != 0) {
+			return p + tokenizer__lowest_bit(mask);
+		}
+		p += 16;
+	}
+#endif
+	while (p < t->end) {
+		u8 c = *p;
+		if (c == '\n' || c == 0 || c >= 0x80) {
+			break;
+		}
+		p++;
+	}
+	return p;
+}
+
+// NOTE: Returns the first '/', '*', NUL or non-ASCII byte from `p`, counting newlines on the way
+u8 *tokenizer__scan_block_comment(Tokenizer *t, u8 *p) {
+#if TOKENIZER_USE_SSE2
+	__m128i nl    = _mm_set1_epi8('\n');
+	__m128i slash = _mm_set1_epi8('/');
+	__m128i star  = _mm_set1_epi8('*');
+	__m128i zero  = _mm_setzero_si128();
+	while (t->end - p >= 16) {
+		__m128i v = _mm_loadu_si128(cast(__m128i *)p);
+		__m128i stop = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, slash), _mm_cmpeq_epi8(v, star)),
+		                            _mm_cmpeq_epi8(v, zero));
+		u32 mask    = cast(u32)(_mm_movemask_epi8(stop) | _mm_movemask_epi8(v));
+		u32 nl_mask = cast(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+		if (mask != 0) {
+			i32 n = tokenizer__lowest_bit(mask);
+			tokenizer__count_newlines(t, p, nl_mask & ((1u<<n)-1));
+			return p+n;
+		}
+		tokenizer__count_newlines(t, p, nl_mask);
+		p += 16;
+	}
+#endif
+	while (p < t->end) {
+		u8 c = *p;
+		if (c == '/' || c == '*' || c == 0 || c >= 0x80) {
+			break;
+		}
+		if (c == '\n') {
+			t->line_count++;
+			t->line = p+1;
+		}
+		p++;
 	}
+	return p;
 }
 
+#if defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+// NOTE: Maps the file read-only followed by at least one zeroed page, so the contents are NUL
+// terminated without copying them. Returns NULL if the file cannot be mapped.
+u8 *tokenizer_map_file(char *c_str, isize *file_size_, isize *map_size_) {
+	int fd = open(c_str, O_RDONLY);
+	if (fd < 0) {
+		return NULL;
+	}
+
+	struct stat st = {0};
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+		close(fd);
+		return NULL;
+	}
+
+	isize page_size = gb_virtual_memory_page_size(NULL);
+	isize file_size = cast(isize)st.st_size;
+	isize map_size  = cast(isize)gb_align_forward(cast(void *)cast(uintptr)file_size, page_size) + page_size;
+
+	// NOTE: Reserve the whole range as zeroed pages first, then map the file over the start of it
+	u8 *base = cast(u8 *)mmap(NULL, map_size, PROT_READ, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED) {
+		close(fd);
+		return NULL;
+	}
+	if (mmap(base, file_size, PROT_READ, MAP_PRIVATE|MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(base, map_size);
+		close(fd);
+		return NULL;
+	}
+	close(fd);
+
+	*file_size_ = file_size;
+	*map_size_  = map_size;
+	return base;
+}
+#endif
+
 TokenizerInitError init_tokenizer(Tokenizer *t, String fullpath) {
 	TokenizerInitError err = TokenizerInit_None;
 
@@ -417,22 +1005,32 @@ TokenizerInitError init_tokenizer(Tokenizer *t, String fullpath) {
 	gb_memcopy(c_str, fullpath.text, fullpath.len);
 	c_str[fullpath.len] = '\0';
 
-	// TODO(bill): Memory map rather than copy contents
-	gbFileContents fc = gb_file_read_contents(heap_allocator(), true, c_str);
+	gbFileContents fc = {0};
+	isize map_size = 0;
+#if defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+	fc.data = tokenizer_map_file(c_str, &fc.size, &map_size);
+#endif
+	if (fc.data == NULL) {
+		fc = gb_file_read_contents(tagged_allocator(MemoryTag_Tokenizer), true, c_str);
+	}
+
 	gb_zero_item(t);
 	if (fc.data != NULL) {
+		t->map_size = map_size;
+		memory_tag_add(MemoryTag_Tokenizer, map_size);
 		t->start = cast(u8 *)fc.data;
 		t->line = t->read_curr = t->curr = t->start;
 		t->end = t->start + fc.size;
 		t->fullpath = fullpath;
 		t->line_count = 1;
+		t->file_id = register_token_file(fullpath, t->start, fc.size);
 
 		advance_to_next_rune(t);
 		if (t->curr_rune == GB_RUNE_BOM) {
 			advance_to_next_rune(t); // Ignore BOM at file beginning
 		}
 
-		array_init(&t->allocated_strings, heap_allocator());
+		array_init(&t->allocated_strings, tagged_allocator(MemoryTag_Tokenizer));
 	} else {
 		gbFile f = {0};
 		gbFileError file_err = gb_file_open(&f, c_str);
@@ -455,7 +1053,12 @@ TokenizerInitError init_tokenizer(Tokenizer *t, String fullpath) {
 }
 
 gb_inline void destroy_tokenizer(Tokenizer *t) {
-	if (t->start != NULL) {
+	if (t->map_size > 0) {
+	#if defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
+		munmap(t->start, t->map_size);
+		memory_tag_add(MemoryTag_Tokenizer, -t->map_size);
+	#endif
+	} else if (t->start != NULL) {
 		gb_free(heap_allocator(), t->start);
 	}
 	for_array(i, t->allocated_strings) {
@@ -465,6 +1068,12 @@ gb_inline void destroy_tokenizer(Tokenizer *t) {
 }
 
 void tokenizer_skip_whitespace(Tokenizer *t) {
+	if (tokenizer_use_fast_paths) {
+		if (rune_is_whitespace(t->curr_rune)) {
+			tokenizer__jump_to(t, tokenizer__scan_whitespace(t, t->read_curr));
+		}
+		return;
+	}
 	while (t->curr_rune == ' ' ||
 	       t->curr_rune == '\t' ||
 	       t->curr_rune == '\n' ||
@@ -494,9 +1103,8 @@ Token scan_number_to_token(Tokenizer *t, bool seen_decimal_point) {
 	Token token = {0};
 	token.kind = Token_Integer;
 	token.string = make_string(t->curr, 1);
-	token.pos.file = t->fullpath;
-	token.pos.line = t->line_count;
-	token.pos.column = t->curr-t->line+1;
+	token.pos.file_id = t->file_id;
+	token.pos.offset  = cast(u32)(t->curr - t->start);
 
 	if (seen_decimal_point) {
 		token.kind = Token_Float;
@@ -743,28 +1351,23 @@ Token tokenizer_get_token(Tokenizer *t) {
 
 	Token token = {0};
 	token.string = make_string(t->curr, 1);
-	token.pos.file = t->fullpath;
-	token.pos.line = t->line_count;
-	token.pos.column = t->curr - t->line + 1;
+	token.pos.file_id = t->file_id;
+	token.pos.offset  = cast(u32)(t->curr - t->start);
 
 	Rune curr_rune = t->curr_rune;
 	if (rune_is_letter(curr_rune)) {
 		token.kind = Token_Ident;
 		while (rune_is_letter(t->curr_rune) || rune_is_digit(t->curr_rune)) {
-			advance_to_next_rune(t);
+			if (tokenizer_use_fast_paths && t->curr_rune < 0x80) {
+				tokenizer__jump_to(t, tokenizer__scan_identifier(t, t->read_curr));
+			} else {
+				advance_to_next_rune(t);
+			}
 		}
 
 		token.string.len = t->curr - token.string.text;
 
-		// NOTE(bill): All keywords are > 1
-		if (token.string.len > 1) {
-			for (i32 k = Token__KeywordBegin+1; k < Token__KeywordEnd; k++) {
-				if (str_eq(token.string, token_strings[k])) {
-					token.kind = cast(TokenKind)k;
-					break;
-				}
-			}
-		}
+		token.kind = keyword_kind(token.string);
 
 	} else if (gb_is_between(curr_rune, '0', '9')) {
 		token = scan_number_to_token(t, false);
@@ -804,7 +1407,7 @@ Token tokenizer_get_token(Tokenizer *t) {
 				tokenizer_err(t, "Invalid rune literal");
 			}
 			token.string.len = t->curr - token.string.text;
-			success = unquote_string(heap_allocator(), &token.string);
+			success = unquote_string(tagged_allocator(MemoryTag_Tokenizer), &token.string);
 			if (success > 0) {
 				if (success == 2) {
 					array_add(&t->allocated_strings, token.string);
@@ -850,7 +1453,7 @@ Token tokenizer_get_token(Tokenizer *t) {
 				}
 			}
 			token.string.len = t->curr - token.string.text;
-			success = unquote_string(heap_allocator(), &token.string);
+			success = unquote_string(tagged_allocator(MemoryTag_Tokenizer), &token.string);
 			if (success > 0) {
 				if (success == 2) {
 					array_add(&t->allocated_strings, token.string);
@@ -900,7 +1503,11 @@ Token tokenizer_get_token(Tokenizer *t) {
 		case '/': {
 			if (t->curr_rune == '/') {
 				while (t->curr_rune != '\n' && t->curr_rune != GB_RUNE_EOF) {
-					advance_to_next_rune(t);
+					if (tokenizer_use_fast_paths && gb_is_between(t->curr_rune, 1, 0x7f)) {
+						tokenizer__jump_to(t, tokenizer__scan_line_comment(t, t->read_curr));
+					} else {
+						advance_to_next_rune(t);
+					}
 				}
 				token.kind = Token_Comment;
 			} else if (t->curr_rune == '*') {
@@ -921,6 +1528,8 @@ Token tokenizer_get_token(Tokenizer *t) {
 							advance_to_next_rune(t);
 							comment_scope--;
 						}
+					} else if (tokenizer_use_fast_paths && gb_is_between(t->curr_rune, 1, 0x7f)) {
+						tokenizer__jump_to(t, tokenizer__scan_block_comment(t, t->read_curr));
 					} else {
 						advance_to_next_rune(t);
 					}
@@ -968,5 +1577,9 @@ Token tokenizer_get_token(Tokenizer *t) {
 	}
 
 	token.string.len = t->curr - token.string.text;
+	if (token.kind == Token_Ident) {
+		token.atom   = intern_string(token.string);
+		token.string = atom_string(token.atom);
+	}
 	return token;
 }
@@ -98,6 +98,7 @@ typedef struct TypeRecord {
 	bool     are_offsets_being_processed;
 	bool     is_packed;
 	bool     is_ordered;
+	bool     is_being_checked; // NOTE: The layout is not cached while the fields may still change
 
 	i64      custom_align; // NOTE(bill): Only used in structs at the moment
 	Entity * names;
@@ -179,8 +180,13 @@ typedef struct Type {
 #undef TYPE_KIND
 	};
 	bool failure;
+	bool canonical; // NOTE: See `type_intern_table`
+	i64  cached_size;  // NOTE: 0 until computed without a failure, see type_size_of_internal
+	i64  cached_align;
 } Type;
 
+typedef Array(Type *) TypePtrArray;
+
 
 // TODO(bill): Should I add extra information here specifying the kind of selection?
 // e.g. field, constant, vector field, type field, etc.
@@ -436,6 +442,104 @@ Type *alloc_type(gbAllocator a, TypeKind kind) {
 }
 
 
+#define MAP_TYPE Type *
+#define MAP_PROC map_type_
+#define MAP_NAME MapType
+#include "map.c"
+
+// NOTE: Pointer, atomic, array, dynamic array, vector, slice and map types are interned, so the
+// types made from the same element types (and count) are the same `Type`. An interned type is
+// canonical if its element types are, as are named types, enums and `basic_types`. Two canonical
+// types are only identical if they are the same `Type` (see are_types_identical).
+//
+// NOTE: The table lives as long as the process, which only runs one build, and an interned type
+// is allocated with the allocator of whoever made it first, so it must never be changed.
+typedef struct TypeInternTable {
+	gbMutex mutex; // NOTE: Procedure bodies are checked in parallel
+	MapType types; // Key: hash of TypeInternKey
+} TypeInternTable;
+
+typedef struct TypeInternKey {
+	TypeKind kind;
+	i64      count;
+	Type *   elem;  // NOTE: The key of a map
+	Type *   value;
+} TypeInternKey;
+
+gb_global TypeInternTable type_intern_table = {0};
+
+void init_type_intern_table(void) {
+	gb_mutex_init(&type_intern_table.mutex);
+	map_type_init(&type_intern_table.types, heap_allocator());
+}
+
+bool is_type_canonical(Type *t) {
+	if (t == NULL) {
+		return false;
+	}
+	switch (t->kind) {
+	case Type_Basic:
+		return t == &basic_types[t->Basic.kind];
+	case Type_Named:
+		return true;
+	case Type_Record:
+		return t->Record.kind == TypeRecord_Enum;
+	}
+	return t->canonical;
+}
+
+bool type_intern__equal(Type *t, TypeInternKey *k) {
+	if (t->kind != k->kind) {
+		return false;
+	}
+	switch (t->kind) {
+	case Type_Pointer:      return t->Pointer.elem == k->elem;
+	case Type_Atomic:       return t->Atomic.elem == k->elem;
+	case Type_Array:        return t->Array.elem == k->elem && t->Array.count == k->count;
+	case Type_DynamicArray: return t->DynamicArray.elem == k->elem;
+	case Type_Vector:       return t->Vector.elem == k->elem && t->Vector.count == k->count;
+	case Type_Slice:        return t->Slice.elem == k->elem;
+	case Type_Map:          return t->Map.key == k->elem && t->Map.value == k->value && t->Map.count == k->count;
+	}
+	return false;
+}
+
+Type *intern_type(gbAllocator a, TypeKind kind, Type *elem, Type *value, i64 count) {
+	TypeInternKey k;
+	gb_zero_item(&k);
+	k.kind  = kind;
+	k.count = count;
+	k.elem  = elem;
+	k.value = value;
+	HashKey key = hashing_proc(&k, gb_size_of(k));
+
+	gb_mutex_lock(&type_intern_table.mutex);
+	MapTypeEntry *e = map_type_multi_find_first(&type_intern_table.types, key);
+	while (e != NULL && !type_intern__equal(e->value, &k)) {
+		e = map_type_multi_find_next(&type_intern_table.types, e);
+	}
+	Type *t = NULL;
+	if (e != NULL) {
+		t = e->value;
+	} else {
+		t = alloc_type(a, kind);
+		switch (kind) {
+		case Type_Pointer:      t->Pointer.elem = elem;                               break;
+		case Type_Atomic:       t->Atomic.elem = elem;                                break;
+		case Type_Array:        t->Array.elem = elem;  t->Array.count = count;        break;
+		case Type_DynamicArray: t->DynamicArray.elem = elem;                          break;
+		case Type_Vector:       t->Vector.elem = elem; t->Vector.count = count;       break;
+		case Type_Slice:        t->Slice.elem = elem;                                 break;
+		case Type_Map:          t->Map.key = elem; t->Map.value = value; t->Map.count = count; break;
+		}
+		t->canonical = is_type_canonical(elem) && (kind != Type_Map || is_type_canonical(value));
+		map_type_multi_insert(&type_intern_table.types, key, t);
+	}
+	gb_mutex_unlock(&type_intern_table.mutex);
+	return t;
+}
+
+
 Type *make_type_basic(gbAllocator a, BasicType basic) {
 	Type *t = alloc_type(a, Type_Basic);
 	t->Basic = basic;
@@ -443,41 +547,27 @@ Type *make_type_basic(gbAllocator a, BasicType basic) {
 }
 
 Type *make_type_pointer(gbAllocator a, Type *elem) {
-	Type *t = alloc_type(a, Type_Pointer);
-	t->Pointer.elem = elem;
-	return t;
+	return intern_type(a, Type_Pointer, elem, NULL, 0);
 }
 
 Type *make_type_atomic(gbAllocator a, Type *elem) {
-	Type *t = alloc_type(a, Type_Atomic);
-	t->Atomic.elem = elem;
-	return t;
+	return intern_type(a, Type_Atomic, elem, NULL, 0);
 }
 
 Type *make_type_array(gbAllocator a, Type *elem, i64 count) {
-	Type *t = alloc_type(a, Type_Array);
-	t->Array.elem = elem;
-	t->Array.count = count;
-	return t;
+	return intern_type(a, Type_Array, elem, NULL, count);
 }
 
 Type *make_type_dynamic_array(gbAllocator a, Type *elem) {
-	Type *t = alloc_type(a, Type_DynamicArray);
-	t->DynamicArray.elem = elem;
-	return t;
+	return intern_type(a, Type_DynamicArray, elem, NULL, 0);
 }
 
 Type *make_type_vector(gbAllocator a, Type *elem, i64 count) {
-	Type *t = alloc_type(a, Type_Vector);
-	t->Vector.elem = elem;
-	t->Vector.count = count;
-	return t;
+	return intern_type(a, Type_Vector, elem, NULL, count);
 }
 
 Type *make_type_slice(gbAllocator a, Type *elem) {
-	Type *t = alloc_type(a, Type_Slice);
-	t->Array.elem = elem;
-	return t;
+	return intern_type(a, Type_Slice, elem, NULL, 0);
 }
 
 
@@ -549,15 +639,13 @@ Type *make_type_proc(gbAllocator a, Scope *scope, Type *params, isize param_coun
 
 bool is_type_valid_for_keys(Type *t);
 
+// NOTE: Map types that are written in the source are not made with this, as their generated types
+// are filled in once the key and value are checked (see check_map_type)
 Type *make_type_map(gbAllocator a, i64 count, Type *key, Type *value) {
-	Type *t = alloc_type(a, Type_Map);
 	if (key != NULL) {
 		GB_ASSERT(is_type_valid_for_keys(key));
 	}
-	t->Map.count = count;
-	t->Map.key   = key;
-	t->Map.value = value;
-	return t;
+	return intern_type(a, Type_Map, key, value, count);
 }
 
 
@@ -924,6 +1012,10 @@ bool are_types_identical(Type *x, Type *y) {
 		return false;
 	}
 
+	if (is_type_canonical(x) && is_type_canonical(y)) {
+		return false;
+	}
+
 	switch (x->kind) {
 	case Type_Basic:
 		if (y->kind == Type_Basic) {
@@ -1254,6 +1346,16 @@ Selection lookup_field_from_index(gbAllocator a, Type *type, i64 index) {
 gb_global Entity *entity__any_data       = NULL;
 gb_global Entity *entity__any_type_info  = NULL;
 
+// NOTE: Called before procedure bodies are checked in parallel, which would race to make these
+void init_entities_of_any(gbAllocator a) {
+	if (entity__any_data == NULL) {
+		entity__any_data = make_entity_field(a, NULL, make_token_ident(str_lit("data")), t_rawptr, false, 0);
+	}
+	if (entity__any_type_info == NULL) {
+		entity__any_type_info = make_entity_field(a, NULL, make_token_ident(str_lit("type_info")), t_type_info_ptr, false, 1);
+	}
+}
+
 Selection lookup_field_with_selection(gbAllocator a, Type *type_, String field_name, bool is_type, Selection sel) {
 	GB_ASSERT(type_ != NULL);
 
@@ -1275,12 +1377,7 @@ Selection lookup_field_with_selection(gbAllocator a, Type *type_, String field_n
 			// `Raw_Any` type?
 			String data_str = str_lit("data");
 			String type_info_str = str_lit("type_info");
-			if (entity__any_data == NULL) {
-				entity__any_data = make_entity_field(a, NULL, make_token_ident(data_str), t_rawptr, false, 0);
-			}
-			if (entity__any_type_info == NULL) {
-				entity__any_type_info = make_entity_field(a, NULL, make_token_ident(type_info_str), t_type_info_ptr, false, 1);
-			}
+			init_entities_of_any(a);
 
 			if (str_eq(field_name, data_str)) {
 				selection_add_index(&sel, 0);
@@ -1416,6 +1513,7 @@ Selection lookup_field_with_selection(gbAllocator a, Type *type_, String field_n
 typedef struct TypePath {
 	Array(Type *) path; // Entity_TypeName;
 	bool failure;
+	bool incomplete; // NOTE: A record that is being checked was reached, so nothing is cached
 } TypePath;
 
 void type_path_init(TypePath *tp) {
@@ -1491,6 +1589,10 @@ i64 type_size_of(gbAllocator allocator, Type *t) {
 	if (t == NULL) {
 		return 0;
 	}
+	i64 cached_size = atomic_load_acquire_i64(&t->cached_size);
+	if (cached_size > 0) {
+		return cached_size;
+	}
 	i64 size;
 	TypePath path = {0};
 	type_path_init(&path);
@@ -1503,6 +1605,10 @@ i64 type_align_of(gbAllocator allocator, Type *t) {
 	if (t == NULL) {
 		return 1;
 	}
+	i64 cached_align = atomic_load_acquire_i64(&t->cached_align);
+	if (cached_align > 0) {
+		return cached_align;
+	}
 	i64 align;
 	TypePath path = {0};
 	type_path_init(&path);
@@ -1511,13 +1617,47 @@ i64 type_align_of(gbAllocator allocator, Type *t) {
 	return align;
 }
 
+i64 type_size_of__uncached (gbAllocator allocator, Type *t, TypePath *path);
+i64 type_align_of__uncached(gbAllocator allocator, Type *t, TypePath *path);
+
+// NOTE: The size and alignment of a type are cached on it once they are computed without a
+// failure, so the path that detects illegal cycles is only walked the first time. A size of 0 is
+// computed again, as it is what an unset cache holds.
+// Other threads may read the cache while it is set, so it is loaded and stored atomically, which
+// also makes what computing the size set (e.g. `variant_block_size`) seen by a thread that reads it.
+i64 type_size_of_internal(gbAllocator allocator, Type *t, TypePath *path) {
+	i64 cached_size = atomic_load_acquire_i64(&t->cached_size);
+	if (cached_size > 0) {
+		return cached_size;
+	}
+	i64 size = type_size_of__uncached(allocator, t, path);
+	if (!path->failure && !path->incomplete && !t->failure) {
+		atomic_store_release_i64(&t->cached_size, size);
+	}
+	return size;
+}
 
 i64 type_align_of_internal(gbAllocator allocator, Type *t, TypePath *path) {
+	i64 cached_align = atomic_load_acquire_i64(&t->cached_align);
+	if (cached_align > 0) {
+		return cached_align;
+	}
+	i64 align = type_align_of__uncached(allocator, t, path);
+	if (!path->failure && !path->incomplete && !t->failure) {
+		atomic_store_release_i64(&t->cached_align, align);
+	}
+	return align;
+}
+
+i64 type_align_of__uncached(gbAllocator allocator, Type *t, TypePath *path) {
 	if (t->failure) {
 		return FAILURE_ALIGNMENT;
 	}
 
 	t = base_type(t);
+	if (t->kind == Type_Record && t->Record.is_being_checked) {
+		path->incomplete = true;
+	}
 
 	switch (t->kind) {
 	case Type_Basic: {
@@ -1687,12 +1827,29 @@ i64 *type_set_offsets_of(gbAllocator allocator, Entity **fields, isize field_cou
 	return offsets;
 }
 
+// NOTE: Procedure bodies are checked in parallel and may lay out the same type at the same time.
+// The mutex is recursive as laying out a type lays out the types of its fields.
+gb_global gbMutex type_offsets_mutex;
+
+bool type_set_offsets__locked(gbAllocator allocator, Type *t);
+
 bool type_set_offsets(gbAllocator allocator, Type *t) {
 	t = base_type(t);
+	if (t->kind == Type_Tuple ? t->Tuple.are_offsets_set : (t->kind == Type_Record && t->Record.are_offsets_set)) {
+		return false;
+	}
+	gb_mutex_lock(&type_offsets_mutex);
+	bool set = type_set_offsets__locked(allocator, t);
+	gb_mutex_unlock(&type_offsets_mutex);
+	return set;
+}
+
+bool type_set_offsets__locked(gbAllocator allocator, Type *t) {
 	if (is_type_struct(t)) {
 		if (!t->Record.are_offsets_set) {
 			t->Record.are_offsets_being_processed = true;
 			t->Record.offsets = type_set_offsets_of(allocator, t->Record.fields, t->Record.field_count, t->Record.is_packed);
+			gb_mfence();
 			t->Record.are_offsets_set = true;
 			return true;
 		}
@@ -1700,6 +1857,7 @@ bool type_set_offsets(gbAllocator allocator, Type *t) {
 		if (!t->Record.are_offsets_set) {
 			t->Record.are_offsets_being_processed = true;
 			t->Record.offsets = type_set_offsets_of(allocator, t->Record.fields, t->Record.field_count, false);
+			gb_mfence();
 			t->Record.are_offsets_set = true;
 			return true;
 		}
@@ -1707,6 +1865,7 @@ bool type_set_offsets(gbAllocator allocator, Type *t) {
 		if (!t->Tuple.are_offsets_set) {
 			t->Record.are_offsets_being_processed = true;
 			t->Tuple.offsets = type_set_offsets_of(allocator, t->Tuple.variables, t->Tuple.variable_count, false);
+			gb_mfence();
 			t->Tuple.are_offsets_set = true;
 			return true;
 		}
@@ -1716,10 +1875,13 @@ bool type_set_offsets(gbAllocator allocator, Type *t) {
 	return false;
 }
 
-i64 type_size_of_internal(gbAllocator allocator, Type *t, TypePath *path) {
+i64 type_size_of__uncached(gbAllocator allocator, Type *t, TypePath *path) {
 	if (t->failure) {
 		return FAILURE_SIZE;
 	}
+	if (t->kind == Type_Record && t->Record.is_being_checked) {
+		path->incomplete = true;
+	}
 
 	switch (t->kind) {
 	case Type_Named: {
@@ -1841,8 +2003,14 @@ i64 type_size_of_internal(gbAllocator allocator, Type *t, TypePath *path) {
 				return FAILURE_SIZE;
 			}
 			if (t->Record.are_offsets_being_processed && t->Record.offsets == NULL) {
-				type_path_print_illegal_cycle(path, path->path.count-1);
-				return FAILURE_SIZE;
+				// NOTE: It is only a cycle if this thread is the one laying it out
+				gb_mutex_lock(&type_offsets_mutex);
+				bool is_cycle = t->Record.offsets == NULL;
+				gb_mutex_unlock(&type_offsets_mutex);
+				if (is_cycle) {
+					type_path_print_illegal_cycle(path, path->path.count-1);
+					return FAILURE_SIZE;
+				}
 			}
 			type_set_offsets(allocator, t);
 			i64 size = t->Record.offsets[count-1] + type_size_of_internal(allocator, t->Record.fields[count-1]->type, path);